@@ -1,27 +1,62 @@
 #include <cstring>
 #include <iostream>
 #include "runner.h"
+#include <board/movegen.h>
+#include <board/board_state.h>
+#include <common/options.h>
 
 
 
-static void movegen_job(unsigned level) {
+static void movegen_job(unsigned level, movegen::SliderBackend backend, bool copyMake) {
+    movegen::init();
+    auto used = movegen::setSliderBackend(backend);
+    std::cout << "sliders: " << (used == movegen::SliderBackend::Pext ? "pext" : "magic")
+              << ", make: " << (copyMake ? "copy" : "unmake") << std::endl;
     for(unsigned i=1; i<=level; i++) {
-        perftGen(i);
+        if (copyMake) perftGen<brd::CopyMake>(i);
+        else perftGen<brd::MakeUnmake>(i);
+        std::cout.flush();
+    }
+}
+
+static void search_job(unsigned level) {
+    movegen::init();
+    for(unsigned i=1; i<=level; i++) {
+        searchGen(i);
+        std::cout.flush();
+    }
+}
+
+static void eval_job(unsigned level, const common::Options& opts, unsigned batch) {
+    movegen::init();
+    static const char* names[] = {"double", "float", "quantized"};
+    std::cout << "nn: " << opts.NNStateFile << ", precision: " << names[static_cast<int>(opts.NNInference)]
+              << ", batch: " << batch << std::endl;
+    for(unsigned i=1; i<=level; i++) {
+        evalGen(i, opts, batch);
         std::cout.flush();
     }
 }
 
 
 int main(int argc, char** argv) {
-    unsigned level = 0;
-    bool is_movegen = false, is_eval = false;
+    unsigned level = 0, batch = 0;
+    bool is_movegen = false, is_eval = false, is_search = false, copyMake = false;
+    auto backend = movegen::SliderBackend::Auto;
+    common::Options opts{};
+    opts.NNStateFile = NN_GZIP_PRETRAINED_WEIGHTS;
     for(int i=1; i<argc; i++) {
         if(std::strcmp("--help", argv[i]) == 0) {
             // show help
             std::cout 
                     << "Help:\n"
-                    << "level           Recursion level (movegen only)\n"
-                    << "job             Type of job: movegen, eval\n"
+                    << "level           Recursion level\n"
+                    << "job             Type of job: movegen, eval, search\n"
+                    << "nn              Weights file (eval only)\n"
+                    << "precision       NN inference: double, float, quantized (eval only)\n"
+                    << "batch           Leaves evaluated at once, 0 is one by one (eval only)\n"
+                    << "sliders         Slider lookup: auto, magic, pext (movegen only)\n"
+                    << "make            Move reverting: unmake, copy (movegen only)\n"
                     << std::endl;
 
             return 0;
@@ -30,9 +65,34 @@ int main(int argc, char** argv) {
         if(std::strcmp("--level", argv[i]) == 0)
             level = std::strtol(argv[++i], nullptr, 10);
         else if(std::strcmp("--job", argv[i]) == 0) {
-            if(std::strcmp("movegen", argv[++i]) == 0)
+            ++i;
+            if(std::strcmp("movegen", argv[i]) == 0)
                 is_movegen = true;
+            else if(std::strcmp("eval", argv[i]) == 0)
+                is_eval = true;
+            else if(std::strcmp("search", argv[i]) == 0)
+                is_search = true;
+        }
+        else if(std::strcmp("--nn", argv[i]) == 0)
+            opts.NNStateFile = argv[++i];
+        else if(std::strcmp("--precision", argv[i]) == 0) {
+            ++i;
+            if(std::strcmp("float", argv[i]) == 0)
+                opts.NNInference = common::NNPrecision::Float;
+            else if(std::strcmp("quantized", argv[i]) == 0)
+                opts.NNInference = common::NNPrecision::Quantized;
+        }
+        else if(std::strcmp("--batch", argv[i]) == 0)
+            batch = std::strtol(argv[++i], nullptr, 10);
+        else if(std::strcmp("--sliders", argv[i]) == 0) {
+            ++i;
+            if(std::strcmp("magic", argv[i]) == 0)
+                backend = movegen::SliderBackend::Magic;
+            else if(std::strcmp("pext", argv[i]) == 0)
+                backend = movegen::SliderBackend::Pext;
         }
+        else if(std::strcmp("--make", argv[i]) == 0)
+            copyMake = std::strcmp("copy", argv[++i]) == 0;
         else {
             std::cout << "unknown args: " << argv[i] 
                 << "\nuse --help"
@@ -42,7 +102,11 @@ int main(int argc, char** argv) {
     }
 
     if(is_movegen)
-        movegen_job(level);
+        movegen_job(level, backend, copyMake);
+    if(is_eval)
+        eval_job(level, opts, batch);
+    if(is_search)
+        search_job(level);
 
 
     return 0;
@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <board/board.h>
+#include <board/board_state.h>
+#include <board/quad_bb.h>
+
+
+static brd::QuadBB initPlanes() {
+    auto [col, nbk, pbq, rqk] = brd::Board{}.getRawBoard();
+    return {col, pbq, nbk, rqk};
+}
+
+// a knight tour back and forth plus a capture/put pair, the make/unmake pattern
+template <typename Kernel>
+static void quadSlide(benchmark::State& st) {
+    brd::QuadBB q = initPlanes();
+    for (auto _ : st) {
+        q = Kernel::slide(q, 1ull << 1, 1ull << 18, PKind::pN, PColor::W);
+        q = Kernel::slide(q, 1ull << 57, 1ull << 42, PKind::pN, PColor::B);
+        q = Kernel::clear(q, 1ull << 52);
+        q = Kernel::put(q, 1ull << 52, PKind::pP, PColor::B);
+        q = Kernel::slide(q, 1ull << 42, 1ull << 57, PKind::pN, PColor::B);
+        q = Kernel::slide(q, 1ull << 18, 1ull << 1, PKind::pN, PColor::W);
+        benchmark::DoNotOptimize(q);
+    }
+}
+
+template <typename Kernel>
+static void quadPieceMasks(benchmark::State& st) {
+    brd::QuadBB q = initPlanes();
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(q);
+        auto pm = Kernel::pieceMasks(q);
+        benchmark::DoNotOptimize(pm);
+    }
+}
+
+struct Scalar_ {
+    static constexpr auto slide = brd::qbb::scalar::slide;
+    static constexpr auto clear = brd::qbb::scalar::clear;
+    static constexpr auto put = brd::qbb::scalar::put;
+    static constexpr auto pieceMasks = brd::qbb::scalar::pieceMasks;
+};
+
+BENCHMARK(quadSlide<Scalar_>);
+BENCHMARK(quadPieceMasks<Scalar_>);
+
+#ifdef __AVX2__
+struct Avx2_ {
+    static constexpr auto slide = brd::qbb::avx2::slide;
+    static constexpr auto clear = brd::qbb::avx2::clear;
+    static constexpr auto put = brd::qbb::avx2::put;
+    static constexpr auto pieceMasks = brd::qbb::avx2::pieceMasks;
+};
+
+BENCHMARK(quadSlide<Avx2_>);
+BENCHMARK(quadPieceMasks<Avx2_>);
+#endif
+
+// the whole Board path: kind lookup, planes, mailbox and the zobrist key
+static void boardSlideKill(benchmark::State& st) {
+    brd::Board board{};
+    for (auto _ : st) {
+        board.slideTo(1, 18);
+        board.slideTo(57, 42);
+        auto [col, kind] = board.kill(52);
+        board.put(kind, col, 52);
+        board.slideTo(42, 57);
+        board.slideTo(18, 1);
+        benchmark::DoNotOptimize(board);
+    }
+}
+BENCHMARK(boardSlideKill);
+
+static void boardPieceMasks(benchmark::State& st) {
+    brd::Board board{};
+    for (auto _ : st) {
+        benchmark::DoNotOptimize(board);
+        benchmark::DoNotOptimize(board.pieceMasks());
+    }
+}
+BENCHMARK(boardPieceMasks);
+
+// make/unmake on a state with some game history, and the copy a spawned search task does
+static void stateMakeUndo(benchmark::State& st) {
+    brd::BoardState state(brd::Board{});
+    const brd::Move moves[] {brd::mkMove(12, 28), brd::mkMove(52, 36), brd::mkMove(6, 21), brd::mkMove(57, 42)};
+    for (auto _ : st) {
+        for (auto& m : moves) state.registerMove(m);
+        for (std::size_t i = 0; i < std::size(moves); i++) state.undo();
+        benchmark::DoNotOptimize(state);
+    }
+}
+BENCHMARK(stateMakeUndo);
+
+static void stateCopy(benchmark::State& st) {
+    brd::BoardState state(brd::Board{});
+    const brd::Move moves[] {brd::mkMove(12, 28), brd::mkMove(52, 36), brd::mkMove(6, 21), brd::mkMove(57, 42)};
+    for (int i = 0; i < 10; i++) {
+        for (auto& m : moves) state.registerMove(m);
+        for (std::size_t j = 0; j < std::size(moves); j++) state.undo();
+    }
+    for (auto& m : moves) state.registerMove(m);
+    for (auto _ : st) {
+        brd::BoardState copy = state;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(stateCopy);
+
+BENCHMARK_MAIN();
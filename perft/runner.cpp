@@ -1,31 +1,148 @@
 #include <chrono>
+#include <iostream>
 #include <board/board_state.h>
+#include <board/movegen.h>
 #include <dbg/debugger.h>
+#include <eval/evaluator.h>
+#include <common/options.h>
+#include <common/stat.h>
+#include <core/CallerThreadExecutor.h>
+#include <search/mtdsearch.h>
+#include <search/tm.h>
+#include <search/tt.h>
+#include <uci/fen.h>
+#include <climits>
+#include <vector>
 
 using namespace std::chrono;
 #define NOOPT(r) asm ("""":"=r"(r):"r"(r))
 
 
+template<typename Policy>
 static uint64_t moveGenRecursive(brd::BoardState& state, unsigned depth, bool firstPlayer) {
-    if(depth <= 0 || state.gameover()) return 0;
+    if(depth <= 0 || state.gameover()) return 1;
 
     uint64_t result = 0;
     brd::MoveList mvList{};
-    if (firstPlayer) state.movegenFor<PColor::W>(mvList);
-    else state.movegenFor<PColor::B>(mvList);
+    if (firstPlayer) state.legalMovegenFor<PColor::W>(mvList);
+    else state.legalMovegenFor<PColor::B>(mvList);
+    if (depth == 1) return mvList.size();
+
     while (mvList.size()) {
         auto move = mvList.pop();
-        state.registerMove(move);
+        auto saved = Policy::make(state, move);
         // Debugger::printBB(state);
-        moveGenRecursive(state, depth-1, !firstPlayer);
-        state.undo();
+        result += moveGenRecursive<Policy>(state, depth-1, !firstPlayer);
+        Policy::unmake(state, saved);
     }
     return result;
 }
 
 
+template<typename Policy>
 void perftGen(unsigned depth) {
     brd::BoardState state(brd::Board{});
-    moveGenRecursive(state, depth, true);
+    auto start = steady_clock::now();
+    auto nodes = moveGenRecursive<Policy>(state, depth, true);
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cout << "perft(" << depth << ") = " << nodes << " " << ms << "ms" << std::endl;
+}
+
+template<typename TLeaf>
+static uint64_t evalRecursive(brd::BoardState& state, TLeaf&& leaf, unsigned depth, bool firstPlayer) {
+    if(depth <= 0 || state.gameover()) {
+        leaf(state);
+        return 1;
+    }
+
+    uint64_t result = 0;
+    brd::MoveList mvList{};
+    if (firstPlayer) state.legalMovegenFor<PColor::W>(mvList);
+    else state.legalMovegenFor<PColor::B>(mvList);
+
+    while (mvList.size()) {
+        auto move = mvList.pop();
+        state.registerMove(move);
+        result += evalRecursive(state, leaf, depth-1, !firstPlayer);
+        state.undo();
+    }
+    return result;
+}
+
+
+void evalGen(unsigned depth, const common::Options& opts, unsigned batch) {
+    eval::NNEvaluator evalu(opts);
+    brd::BoardState state(brd::Board{});
+    double sum = 0.0;
+    std::vector<int8_t> planes{};
+    std::vector<double> scores(batch);
+    auto flush = [&]() {
+        const std::size_t count = planes.size() / brd::nnLayerSize();
+        evalu.evaluateRawBatch(planes.data(), count, scores.data());
+        for (std::size_t i=0; i<count; i++) sum += scores[i];
+        planes.clear();
+    };
+
+    auto start = steady_clock::now();
+    uint64_t nodes = 0;
+    if (batch) {
+        // reserve() may allocate more, the batch is counted by the planes of `batch` positions
+        const std::size_t batchPlanes = static_cast<std::size_t>(batch) * brd::nnLayerSize();
+        planes.reserve(batchPlanes);
+        nodes = evalRecursive(state, [&](const brd::BoardState& leaf) {
+            planes.insert(planes.end(), leaf.getNNL().begin(), leaf.getNNL().end());
+            if (planes.size() == batchPlanes) flush();
+        }, depth, true);
+        flush();
+    }
+    else {
+        nodes = evalRecursive(state, [&](const brd::BoardState& leaf) { sum += evalu.evaluateRaw(leaf); }, depth, true);
+    }
+    auto us = duration_cast<microseconds>(steady_clock::now() - start).count();
+    std::cout << "evals(" << depth << ") = " << nodes << " " << us / 1000 << "ms "
+              << static_cast<uint64_t>(nodes * 1e6 / std::max<int64_t>(us, 1)) << " evals/s"
+              << " mean " << sum / static_cast<double>(nodes) << std::endl;
+}
+
+// opening, middlegame and endgame positions with tactics, the engine plays the side to move
+static const char* searchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r1bqkb1r/pppp1ppp/2n2n2/4p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+};
+
+void searchGen(unsigned depth) {
+    uint64_t nodes = 0, qnodes = 0, passes = 0, cuts = 0, firstCuts = 0;
+    auto start = steady_clock::now();
+    for (auto fen : searchPositions) {
+        common::Options opts{};
+        opts.MaxDepthPly = depth;
+        common::Stat stat{};
+        search::TimeManager tm{};
+        tm.setTimeout(ULONG_MAX);
+        tm.startCounting();
+        search::TTable ttable(opts, stat);
+        brd::BoardState state(brd::Board{});
+        uci::Fen{}.apply(fen, state);
+        opts.EngineSide = state.FenGetNextPlayer().value_or(PColor::W);
+
+        eval::MaterialEvaluator evalu{opts};
+        search::MtdSearch<exec::CallerThreadExecutor> searcher{opts, stat, tm, ttable, evalu};
+        auto report = searcher.pvMove(state);
+        std::cout << "  " << report.pvMove << " nodes " << stat.NodesSearched << " qnodes " << stat.QNodes
+                  << " passes " << stat.MtdPasses << " cuts " << stat.CutNodes << "/" << stat.FirstMoveCuts
+                  << "  " << fen << std::endl;
+        nodes += stat.NodesSearched, qnodes += stat.QNodes, passes += stat.MtdPasses;
+        cuts += stat.CutNodes, firstCuts += stat.FirstMoveCuts;
+    }
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cout << "search(" << depth << ") nodes " << nodes << " qnodes " << qnodes
+              << " passes " << passes << " first move cuts " << (cuts ? 100.0 * firstCuts / cuts : 0.0) << "%"
+              << " " << ms << "ms" << std::endl;
 }
 
+template void perftGen<brd::MakeUnmake>(unsigned);
+template void perftGen<brd::CopyMake>(unsigned);
@@ -2,6 +2,21 @@
 #define INCLUDE_PERFT_RUNNER_H_
 
 
+namespace common { struct Options; }
+
+template<typename Policy>
 void perftGen(unsigned depth);
 
+/*
+ * @brief   Evaluate every leaf of the depth tree with the NN of the options,
+ *          batch > 0 collects the leaves and evaluates batch of them at once
+ */
+void evalGen(unsigned depth, const common::Options& opts, unsigned batch = 0);
+
+/*
+ * @brief   Fixed depth searches of a set of positions with the material evaluator,
+ *          prints the nodes, the quiescence nodes and the MTD(f) passes
+ */
+void searchGen(unsigned depth);
+
 #endif  // INCLUDE_PERFT_RUNNER_H_
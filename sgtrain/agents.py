@@ -125,7 +125,7 @@ class SelfPlayAgent(Agent):
         for i in range(0, moves.size):
             mv = moves.getMove(i)
             sgt.makeMoveSilently(self._cdc, mv)
-            pred = self._model(torch.from_numpy(self._in_layer)).item()
+            pred = self._model(torch.from_numpy(self._in_layer).double()).item()
             sgt.undoMoveSilently(self._cdc)
             if m < pred or move is None:
                 m = pred
@@ -4,6 +4,7 @@ import torch
 import pandas as pd
 import gzip
 import io
+import struct
 import sgfiles
 
 
@@ -31,3 +32,55 @@ def sg_convert_weights():
         file.write(res)
 
     return 0
+
+
+# Binary weight file, the layout is documented in src/eval/nn_weights.h
+SGNN_MAGIC = b"SGNNWGT\0"
+SGNN_VERSION = 1
+SGNN_ALIGNMENT = 64
+SGNN_DTYPE_F64 = 0
+
+
+def _align_up(v):
+    return (v + SGNN_ALIGNMENT - 1) // SGNN_ALIGNMENT * SGNN_ALIGNMENT
+
+
+def _fnv1a64(data):
+    h = 0xcbf29ce484222325
+    for b in data:
+        h = ((h ^ b) * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
+
+def sg_export_binary_weights():
+    model = models.SgModel()
+    if not os.path.isfile(sgfiles.SG_MODEL_WEIGHTS_FILE):
+        return 1
+
+    model.load_state_dict(torch.load(sgfiles.SG_MODEL_WEIGHTS_FILE, weights_only=True))
+    state_ = model.state_dict()
+    # the conv1d weight (128, 40, 8) goes input-major: a set input is one contiguous column
+    tensors = [
+        ("l1.weight", state_["l1.weight"].reshape(state_["l1.weight"].shape[0], -1).t()),
+        ("l2.weight", state_["l2.weight"]),
+        ("l2.bias", state_["l2.bias"]),
+        ("lout.weight", state_["lout.weight"]),
+        ("lout.bias", state_["lout.bias"]),
+    ]
+
+    payload_offset = _align_up(64 + 64 * len(tensors))
+    entries = b""
+    payload = b""
+    for name, t in tensors:
+        raw = t.detach().to(torch.float64).contiguous().numpy().astype("<f8").tobytes()
+        shape = [*t.shape] + [0] * (3 - t.dim())
+        entries += struct.pack("<32sI3IQQ", name.encode(), t.dim(), *shape,
+                               payload_offset + len(payload), t.numel())
+        payload += raw + bytes(_align_up(len(raw)) - len(raw))
+
+    header = struct.pack("<8s4I3Q16x", SGNN_MAGIC, SGNN_VERSION, SGNN_DTYPE_F64, len(tensors), 0,
+                         payload_offset, len(payload), _fnv1a64(payload))
+    with open(sgfiles.BINARY_WEIGHT_FILE, "wb") as file:
+        file.write(header + entries + bytes(payload_offset - len(header) - len(entries)) + payload)
+
+    return 0
@@ -35,6 +35,10 @@ if __name__ == "__main__":
                         action="store_true",
                         help="Convert weights into sg format")
 
+    parser.add_argument("--export_binary",
+                        action="store_true",
+                        help="Export weights into the mmap-able binary format")
+
     parser.add_argument("--engine_path", nargs='?',
                         required=False,
                         help="Engine executable path")
@@ -51,6 +55,9 @@ if __name__ == "__main__":
     if args.convert_weights:
         res = converters.sg_convert_weights()
         exit(res)
+    if args.export_binary:
+        res = converters.sg_export_binary_weights()
+        exit(res)
 
     epochs = args.epochs
     plot_epochs = args.plot_ep
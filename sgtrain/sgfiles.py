@@ -2,3 +2,4 @@ SGD_OPTIM_STATE_FILE = "sgsgdo.pt"
 ADAM_OPTIM_STATE_FILE = "sgadamo.pt"
 SG_MODEL_WEIGHTS_FILE = "sgw.pt"
 WEIGHT_FILE = "sgw_native.nn"
+BINARY_WEIGHT_FILE = "sgw_native.sgnn"
@@ -1,10 +1,12 @@
 #include "board.h"
+#include <algorithm>
 #include <bit>
 #include <cstdint>
 #include "../dbg/sg_assert.h"
 #include "move.h"
 #include "movegen.h"
 #include "../core/gens.h"
+#include "../core/scores.h"
 #include "board_state.h"
 #include "../dbg/debugger.h"
 
@@ -54,9 +56,19 @@ static void initKey(BrdKey_t& key, Board& board) {
 }
 
 brd::Board::Board() noexcept {
+    rebuildMailbox_();
     initKey(m_key, *this);
 }
 
+void Board::rebuildMailbox_() noexcept {
+    std::fill(std::begin(m_mailbox), std::end(m_mailbox), PKind::None);
+    const PieceMasks pm = pieceMasks();
+    for (int kind = PKind::pP; kind <= PKind::pR; kind++) {
+        BB mask = pm.masks[PColor::W][kind] | pm.masks[PColor::B][kind];
+        while (mask) m_mailbox[popLsb(mask)] = static_cast<PKind>(kind);
+    }
+}
+
 bool Board::empty(SQ sq) const noexcept {
     return emptyM(1ull << sq);
 }
@@ -89,25 +101,6 @@ PColor Board::getColor(BB mask) const noexcept {
     return static_cast<PColor>(!(mask & m_bb_col));
 }
 
-PKind Board::getKind(BB mask) const noexcept {
-    if(m_bb_nbk & mask) {
-        if(m_bb_rqk & mask) return PKind::pK;
-        if(m_bb_pbq & mask) return PKind::pB;
-        return PKind::pN;
-    }
-    if(m_bb_rqk & mask) {
-        if(m_bb_pbq & mask) return PKind::pQ;
-        return PKind::pR;
-    }
-    if (m_bb_pbq & mask) return PKind::pP;
-
-    return PKind::None;
-}
-
-inline static BB slideTo_(BB bb, BB fromMask, BB toMask) {
-    return (bb & ~fromMask) | toMask;
-}
-
 PKind Board::slideTo(SQ from, SQ to) noexcept {
     BB fromMask = 1ull << from;
     BB toMask = 1ull << to;
@@ -121,7 +114,8 @@ PKind Board::slideTo(SQ from, SQ to) noexcept {
 }
 
 PKind Board::slideToM_(BB fromMask, BB toMask) noexcept {
-    auto kind = getKind(fromMask);
+    const SQ from = std::countr_zero(fromMask);
+    auto kind = m_mailbox[from];
 
     // === ASSERTIONS
     if (empty(std::countr_zero(fromMask))) {
@@ -136,28 +130,9 @@ PKind Board::slideToM_(BB fromMask, BB toMask) noexcept {
     SG_ASSERT(std::popcount(toMask) == 1);
     // === !ASSERTIONS
 
-    if (kind == PKind::pK) {
-        m_bb_rqk = slideTo_(m_bb_rqk, fromMask, toMask);
-        m_bb_nbk = slideTo_(m_bb_nbk, fromMask, toMask);
-    }
-    else if (kind == PKind::pP)
-        m_bb_pbq = slideTo_(m_bb_pbq, fromMask, toMask);
-    else if (kind == PKind::pQ) {
-        m_bb_pbq = slideTo_(m_bb_pbq, fromMask, toMask);
-        m_bb_rqk = slideTo_(m_bb_rqk, fromMask, toMask);
-    }
-    else if (kind == PKind::pR)
-        m_bb_rqk = slideTo_(m_bb_rqk, fromMask, toMask);
-    else if (kind == PKind::pN)
-        m_bb_nbk = slideTo_(m_bb_nbk, fromMask, toMask);
-    else if (kind == PKind::pB) {
-        m_bb_pbq = slideTo_(m_bb_pbq, fromMask, toMask);
-        m_bb_nbk = slideTo_(m_bb_nbk, fromMask, toMask);
-    }
-    else
-        m_bb_pbq = slideTo_(m_bb_pbq, fromMask, toMask);
-
-    if (m_bb_col & fromMask) { m_bb_col = (m_bb_col & ~fromMask) | toMask; }
+    setPlanes_(qbb::kernel::slide(planes_(), fromMask, toMask, kind, getColor(fromMask)));
+    m_mailbox[from] = PKind::None;
+    m_mailbox[std::countr_zero(toMask)] = kind;
 
     return kind;
 }
@@ -167,12 +142,10 @@ std::pair<PColor, PKind> Board::kill(SQ sq) noexcept {
     SG_ASSERT(!emptyM(sqMask));
 
     PColor col = static_cast<PColor>(!(m_bb_col & sqMask));
-    PKind kind = getKind(sqMask);
+    PKind kind = m_mailbox[sq];
+    m_mailbox[sq] = PKind::None;
 
-    m_bb_nbk &= ~sqMask;
-    m_bb_pbq &= ~sqMask;
-    m_bb_rqk &= ~sqMask;
-    m_bb_col &= ~sqMask;
+    setPlanes_(qbb::kernel::clear(planes_(), sqMask));
 
     xorKey(m_key, col, kind, sq);
     return {col, kind};
@@ -188,89 +161,415 @@ uint64_t Board::key() const noexcept {
 
 template <PColor Color, PKind Kind>
 void Board::movegen(MoveList& mvList, const BoardState& state) const noexcept {
-    uint64_t enemyMask = m_bb_col;
-    if constexpr (!Color) enemyMask = ~enemyMask;
+    movegen_<Color, Kind, false, MG_ALL>(mvList, state, CheckInfo{}, occupancy(), enemyMask_<Color>());
+}
+
+template <PColor Color, PKind Kind>
+void Board::movegen(MoveList& mvList, const BoardState& state, const CheckInfo& ci) const noexcept {
+    movegen_<Color, Kind, true, MG_ALL>(mvList, state, ci, occupancy(), enemyMask_<Color>());
+}
+
+template <PColor Color, MGType Type>
+void Board::movegenStage(MoveList& mvList, const BoardState& state, const CheckInfo& ci) const noexcept {
+    const BB occupied = occupancy();
+    const BB enemyMask = enemyMask_<Color>();
+
+    movegen_<Color, PKind::pK, true, Type>(mvList, state, ci, occupied, enemyMask);
+    // double check: only the king can move
+    if (!ci.evasion) return;
+
+    movegen_<Color, PKind::pP, true, Type>(mvList, state, ci, occupied, enemyMask);
+    movegen_<Color, PKind::pN, true, Type>(mvList, state, ci, occupied, enemyMask);
+    movegen_<Color, PKind::pB, true, Type>(mvList, state, ci, occupied, enemyMask);
+    movegen_<Color, PKind::pR, true, Type>(mvList, state, ci, occupied, enemyMask);
+    movegen_<Color, PKind::pQ, true, Type>(mvList, state, ci, occupied, enemyMask);
+}
+
+template <PColor Color>
+bool Board::isLegal(const Move& move, const BoardState& state, const CheckInfo& ci) const noexcept {
+    const BB fromMask = 1ull << move.from;
+    if (emptyM(fromMask) || getColor(fromMask) != Color) return false;
 
     const BB occupied = occupancy();
-    auto pcMask = getPieceSqMask<Color, Kind>();
+    const BB enemyMask = enemyMask_<Color>();
+    MoveList mvList{};
+    switch (getKind(fromMask)) {
+        case PKind::pK: movegen_<Color, PKind::pK, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        case PKind::pP: movegen_<Color, PKind::pP, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        case PKind::pN: movegen_<Color, PKind::pN, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        case PKind::pB: movegen_<Color, PKind::pB, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        case PKind::pR: movegen_<Color, PKind::pR, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        case PKind::pQ: movegen_<Color, PKind::pQ, true, MG_ALL>(mvList, state, ci, occupied, enemyMask, fromMask); break;
+        default: return false;
+    }
+
+    for (std::size_t i=0; i<mvList.size(); i++)
+        if (mvList[i] == move) return true;
+    return false;
+}
+
+template <PColor Color, PKind Kind, bool Legal, MGType Type>
+void Board::movegen_(MoveList& mvList, const BoardState& state, const CheckInfo& ci,
+                     BB occupied, BB enemyMask, BB fromMask) const noexcept {
+    if constexpr (Legal && Kind != PKind::pK) {
+        // double check: only the king can move
+        if (!ci.evasion) return;
+    }
+    if constexpr (Kind == PKind::pP) {
+        pawnMovegen_<Color, Legal, Type>(mvList, state, ci, occupied, enemyMask, fromMask);
+        return;
+    }
+
+    auto pcMask = getPieceSqMask<Color, Kind>() & fromMask;
 
     while(pcMask) {
         SQ from = std::countr_zero(pcMask);
         pcMask &= (pcMask - 1);
-        uint64_t qMoves, aMoves;
-        if constexpr (Kind == PKind::pP) {
-            qMoves = movegen::getPawnMoves<Color>(from, state);
-            aMoves = movegen::getPawnAttacks<Color>(from);
-            auto toEnpass = movegen::getEnpassantAttack<Color>(from, state);
-            if(toEnpass)
-                mvList.push(brd::mkEnpass(from, toEnpass));
-        }
-        else
-            qMoves = aMoves = movegen::getPieceOccupancy<Color, Kind>(from, occupied);
-
-        if(!qMoves && !aMoves) continue;
+        const BB pMoves = movegen::getPieceOccupancy<Color, Kind>(from, occupied);
+        if(!pMoves) continue;
 
         // quiet and attack moves
-        auto qm = qMoves & ~occupied;
-        auto am = aMoves & occupied & enemyMask;
-        auto moves = qm | am;
+        auto qm = pMoves & ~occupied;
+        auto am = pMoves & occupied & enemyMask;
+        BB moves = 0x00;
+        if constexpr (Type & MG_QUIETS) moves |= qm;
+        if constexpr (Type & MG_CAPTURES) moves |= am;
+
+        if constexpr (Legal) {
+            if constexpr (Kind == PKind::pK) moves &= ~ci.danger;
+            else {
+                moves &= ci.evasion;
+                if (ci.pinned & (1ull << from)) moves &= movegen::line(ci.kingSq, from);
+            }
+        }
+
         while(moves) {
             mvList.push(brd::mkMove(from, std::countr_zero(moves)));
             moves &= (moves - 1);
         }
 
-        if constexpr (Kind == PKind::pK) {
-            if (state.kindNotMoved<Color>())
-                movegen::genCastling<Color>(from, mvList, state);
+        if constexpr (Kind == PKind::pK && (Type & MG_QUIETS)) {
+            if (state.kindNotMoved<Color>()) {
+                if constexpr (Legal) movegen::genCastling<Color>(from, mvList, state, ci);
+                else movegen::genCastling<Color>(from, mvList, state);
+            }
         }
     }
 }
 
+template<int Delta, bool Legal>
+static inline void pushPawnMoves_(MoveList& mvList, BB targets, const CheckInfo& ci) noexcept {
+    while (targets) {
+        SQ to = popLsb(targets);
+        SQ from = to - Delta;
+        if constexpr (Legal) {
+            // a pinned pawn moves only along the pin line
+            if ((ci.pinned & (1ull << from)) && !(movegen::line(ci.kingSq, from) & (1ull << to))) continue;
+        }
+        mvList.push(brd::mkMove(from, to));
+    }
+}
 
-void Board::put(PKind kind, PColor color, SQ sq) noexcept {
-    SG_ASSERT(kind != PKind::None);
+template <PColor Color, bool Legal, MGType Type>
+void Board::pawnMovegen_(MoveList& mvList, const BoardState& state, const CheckInfo& ci,
+                         BB occupied, BB enemyMask, BB fromMask) const noexcept {
+    constexpr PColor Enemy = Color == PColor::W ? PColor::B : PColor::W;
+    constexpr int up = Color == PColor::W ? 8 : -8;
+    constexpr int upLeft = Color == PColor::W ? 7 : -9;
+    constexpr int upRight = Color == PColor::W ? 9 : -7;
+    constexpr BB promoRank = Color == PColor::W ? NRank::r8 : NRank::r1;
+    constexpr BB doublePushRank = Color == PColor::W ? NRank::r3 : NRank::r6;
+
+    const BB pawns = getPieceSqMask<Color, PKind::pP>() & fromMask;
+    if (!pawns) return;
+
+    const BB targets = Legal ? ci.evasion : ~0x00ULL;
+    const BB empty = ~occupied;
+    BB push = movegen::shiftM<up>(pawns) & empty;
+    BB doublePush = movegen::shiftM<up>(push & doublePushRank) & empty & targets;
+    push &= targets;
+    BB captL = movegen::shiftM<upLeft>(pawns & ~NFile::fA) & occupied & enemyMask & targets;
+    BB captR = movegen::shiftM<upRight>(pawns & ~NFile::fH) & occupied & enemyMask & targets;
+
+    // promotions go together with captures
+    if constexpr (Type == MG_CAPTURES) {
+        push &= promoRank;
+        doublePush = 0x00;
+    }
+    else if constexpr (Type == MG_QUIETS) {
+        push &= ~promoRank;
+        captL = captR = 0x00;
+    }
 
-    BB mask = 1ull << sq;
-    switch(kind) {
-        case PKind::pQ: {
-                            m_bb_rqk |= mask;
-                            m_bb_pbq |= mask;
-                            break;
-                        }
-        case PKind::pB: {
-                            m_bb_nbk |= mask;
-                            m_bb_pbq |= mask;
-                            break;
-                        }
-        case PKind::pK: {
-                            m_bb_rqk |= mask;
-                            m_bb_nbk |= mask;
-                            break;
-                        }
-
-
-        case PKind::pN: {
-                            m_bb_nbk |= mask;
-                            break;
-                        }
-        case PKind::pR: {
-                            m_bb_rqk |= mask;
-                            break;
-                        }
-
-        default: {
-                     m_bb_pbq |= mask;
-                     break;
-                 }
+    pushPawnMoves_<up, Legal>(mvList, push, ci);
+    pushPawnMoves_<2*up, Legal>(mvList, doublePush, ci);
+    pushPawnMoves_<upLeft, Legal>(mvList, captL, ci);
+    pushPawnMoves_<upRight, Legal>(mvList, captR, ci);
+
+    if constexpr (Type & MG_CAPTURES) {
+        SQ toEnpass = movegen::getEnpassantSq<Color>(state);
+        if (!toEnpass) return;
+        BB attackers = movegen::getPawnAttacksM<Enemy>(1ull << toEnpass) & pawns;
+        while (attackers) {
+            SQ from = popLsb(attackers);
+            if (!Legal || enpassLegal_<Color>(from, toEnpass, ci))
+                mvList.push(brd::mkEnpass(from, toEnpass));
+        }
+    }
+}
+
+template <PColor Color>
+bool Board::enpassLegal_(SQ from, SQ to, const CheckInfo& ci) const noexcept {
+    if (ci.kingSq == SQ_CNT) return true;
+
+    constexpr PColor Enemy = Color == PColor::W ? PColor::B : PColor::W;
+    const BB victim = 1ull << (Color == PColor::W ? to - 8 : to + 8);
+    const BB enemyRQ = getPieceSqMask<Enemy, PKind::pR>() | getPieceSqMask<Enemy, PKind::pQ>();
+    const BB enemyBQ = getPieceSqMask<Enemy, PKind::pB>() | getPieceSqMask<Enemy, PKind::pQ>();
+
+    // a knight or another pawn check can't be resolved by the enpassant capture
+    if (ci.checkers & ~victim & ~(enemyRQ | enemyBQ)) return false;
+
+    // both pawns leave their squares, so test the sliders on the changed occupancy
+    const BB occ = (occupancy() ^ (1ull << from) ^ victim) | (1ull << to);
+    return !(movegen::getRookOccupancy(ci.kingSq, occ) & enemyRQ)
+        && !(movegen::getBishopOccupancy(ci.kingSq, occ) & enemyBQ);
+}
+
+BB Board::attackersTo(SQ sq, BB occupied) const noexcept {
+    const BB sqMask = 1ull << sq;
+    const BB pawns = m_bb_pbq & ~m_bb_nbk & ~m_bb_rqk;
+    const BB rookLike = m_bb_rqk & ~m_bb_nbk;
+    const BB bishopLike = m_bb_pbq & (m_bb_nbk | m_bb_rqk);
+
+    return ((movegen::getRookOccupancy(sq, occupied) & rookLike)
+        | (movegen::getBishopOccupancy(sq, occupied) & bishopLike)
+        | (movegen::getKnightOccupancy(sq) & m_bb_nbk & ~m_bb_pbq & ~m_bb_rqk)
+        | (movegen::getKingOccupancy(sq) & m_bb_nbk & m_bb_rqk)
+        | (movegen::getPawnAttacksM<PColor::B>(sqMask) & pawns & ~m_bb_col)
+        | (movegen::getPawnAttacksM<PColor::W>(sqMask) & pawns & m_bb_col)) & occupied;
+}
+
+BB Board::attackersTo(SQ sq) const noexcept {
+    return attackersTo(sq, occupancy());
+}
+
+bool Board::isSquareAttacked(SQ sq, PColor byColor) const noexcept {
+    const BB sqMask = 1ull << sq;
+    const BB side = byColor ? ~m_bb_col : m_bb_col;
+    const BB pawnSquares = byColor ? movegen::getPawnAttacksM<PColor::B>(sqMask)
+                                   : movegen::getPawnAttacksM<PColor::W>(sqMask);
+
+    // leapers first, they are a single load each
+    if (movegen::getKnightOccupancy(sq) & m_bb_nbk & ~m_bb_pbq & ~m_bb_rqk & side) return true;
+    if (pawnSquares & m_bb_pbq & ~m_bb_nbk & ~m_bb_rqk & side) return true;
+    if (movegen::getKingOccupancy(sq) & m_bb_nbk & m_bb_rqk & side) return true;
+
+    const BB occ = occupancy();
+    const BB rookLike = m_bb_rqk & ~m_bb_nbk & side;
+    const BB bishopLike = m_bb_pbq & (m_bb_nbk | m_bb_rqk) & side;
+    return (rookLike && (movegen::getRookOccupancy(sq, occ) & rookLike))
+        || (bishopLike && (movegen::getBishopOccupancy(sq, occ) & bishopLike));
+}
+
+BB Board::leastValuable_(BB attackers, PKind& kind) const noexcept {
+    const BB odd = m_bb_pbq ^ m_bb_nbk ^ m_bb_rqk;
+    const std::pair<PKind, BB> byValue[] {
+        {PKind::pP, m_bb_pbq & odd}, {PKind::pN, m_bb_nbk & odd}, {PKind::pB, m_bb_pbq & m_bb_nbk},
+        {PKind::pR, m_bb_rqk & odd}, {PKind::pQ, m_bb_pbq & m_bb_rqk}, {PKind::pK, m_bb_nbk & m_bb_rqk}};
+    for (auto [k, mask] : byValue) {
+        if (BB found = attackers & mask) {
+            kind = k;
+            return found & -found;
+        }
     }
+    return 0x00;
+}
+
+// the king can't be exchanged, its value only has to exceed anything on the board
+static constexpr Score seeValue_(PKind kind) noexcept {
+    return kind == PKind::pK ? 2 * INIT_MATERIAL : PieceScores[kind];
+}
+
+bool Board::isCaptureOrPromo(const Move& move) const noexcept {
+    if (move.castling) return false;
+    if (move.isEnpass || kindAt(move.to) != PKind::None) return true;
+    return kindAt(move.from) == PKind::pP && ((1ull << move.to) & (NRank::r1 | NRank::r8));
+}
+
+Score Board::see(const Move& move) const noexcept {
+    if (move.castling) return 0x00;
+
+    const SQ to = move.to;
+    const BB fromMask = 1ull << move.from;
+    BB occ = occupancy() ^ fromMask;
+    if (move.isEnpass) occ ^= 1ull << (move.from < move.to ? to - 8 : to + 8);
+
+    const BB rookLike = m_bb_rqk & ~m_bb_nbk;
+    const BB bishopLike = m_bb_pbq & (m_bb_nbk | m_bb_rqk);
+    BB attackers = attackersTo(to, occ);
+
+    Score gain[32];
+    int depth = 0;
+    gain[0] = move.isEnpass ? PAWN_SCORE : seeValue_(kindAt(to));
+    PKind attacker = kindAt(move.from);
+    BB side = (m_bb_col & fromMask) ? ~m_bb_col : m_bb_col;     // the side to recapture
+
+    while (depth < 31) {
+        const BB sideAttackers = attackers & side;
+        if (!sideAttackers) break;
+
+        PKind next;
+        const BB lva = leastValuable_(sideAttackers, next);
+        // the king recaptures only if the square isn't defended anymore
+        if (next == PKind::pK && (attackers & ~side & ~lva)) break;
+
+        depth++;
+        gain[depth] = seeValue_(attacker) - gain[depth - 1];
+        if (std::max<Score>(-gain[depth - 1], gain[depth]) < 0) break;
+
+        occ ^= lva;
+        // uncover the x-ray attackers behind the removed piece
+        if (next == PKind::pP || next == PKind::pB || next == PKind::pQ)
+            attackers |= movegen::getBishopOccupancy(to, occ) & bishopLike;
+        if (next == PKind::pR || next == PKind::pQ)
+            attackers |= movegen::getRookOccupancy(to, occ) & rookLike;
+        attackers &= occ;
+
+        attacker = next;
+        side = ~side;
+    }
+
+    while (depth) {
+        gain[depth - 1] = -std::max<Score>(-gain[depth - 1], gain[depth]);
+        depth--;
+    }
+    return gain[0];
+}
+
+bool Board::seeGE(const Move& move, Score threshold) const noexcept {
+    if (move.castling) return 0 >= threshold;
+
+    const SQ to = move.to;
+    const BB fromMask = 1ull << move.from;
+
+    Score swap = (move.isEnpass ? PAWN_SCORE : seeValue_(kindAt(to))) - threshold;
+    if (swap < 0) return false;
+    swap = seeValue_(kindAt(move.from)) - swap;
+    if (swap <= 0) return true;
+
+    BB occ = occupancy() ^ fromMask;
+    if (move.isEnpass) occ ^= 1ull << (move.from < move.to ? to - 8 : to + 8);
+
+    const BB rookLike = m_bb_rqk & ~m_bb_nbk;
+    const BB bishopLike = m_bb_pbq & (m_bb_nbk | m_bb_rqk);
+    BB attackers = attackersTo(to, occ);
+    BB side = (m_bb_col & fromMask) ? ~m_bb_col : m_bb_col;
+    bool res = true;
+
+    while (true) {
+        attackers &= occ;
+        const BB sideAttackers = attackers & side;
+        if (!sideAttackers) break;
+        res = !res;
+
+        PKind next;
+        const BB lva = leastValuable_(sideAttackers, next);
+        if (next == PKind::pK)
+            // the king can't recapture a defended square
+            return (attackers & ~side) ? !res : res;
+
+        if ((swap = seeValue_(next) - swap) < res) break;
+
+        occ ^= lva;
+        if (next == PKind::pP || next == PKind::pB || next == PKind::pQ)
+            attackers |= movegen::getBishopOccupancy(to, occ) & bishopLike;
+        if (next == PKind::pR || next == PKind::pQ)
+            attackers |= movegen::getRookOccupancy(to, occ) & rookLike;
+        side = ~side;
+    }
+    return res;
+}
+
+template <PColor Color, PKind Kind>
+inline static BB enemyAttacks_(BB pieceMask, BB occ) noexcept {
+    BB r = 0x00;
+    while (pieceMask) r |= movegen::getPieceOccupancy<Color, Kind>(popLsb(pieceMask), occ);
+    return r;
+}
+
+template<PColor Color>
+CheckInfo Board::checkInfo() const noexcept {
+    constexpr PColor Enemy = Color == PColor::W ? PColor::B : PColor::W;
+    CheckInfo ci{};
+
+    const BB kingMask = getPieceSqMask<Color, PKind::pK>();
+    if (!kingMask) return ci;
+    const SQ kingSq = std::countr_zero(kingMask);
+    ci.kingSq = kingSq;
+
+    const BB occ = occupancy();
+    const BB own = Color ? occ & ~m_bb_col : occ & m_bb_col;
+    const PieceMasks pm = pieceMasks();
+    const BB (&enemy)[7] = pm.masks[Enemy];
+    const BB enemyRQ = enemy[PKind::pR] | enemy[PKind::pQ];
+    const BB enemyBQ = enemy[PKind::pB] | enemy[PKind::pQ];
+    const BB enemyN = enemy[PKind::pN];
+    const BB enemyP = enemy[PKind::pP];
+
+    ci.checkers = attackersTo(kingSq, occ) & ~own & ~enemy[PKind::pK];
+
+    // x-ray through the own pieces to find the pinners
+    const BB enemyOcc = occ & ~own;
+    BB snipers = (movegen::getRookOccupancy(kingSq, enemyOcc) & enemyRQ)
+        | (movegen::getBishopOccupancy(kingSq, enemyOcc) & enemyBQ);
+    while (snipers) {
+        SQ sniperSq = popLsb(snipers);
+        BB blockers = movegen::between(kingSq, sniperSq) & occ;
+        if (std::popcount(blockers) == 1 && (blockers & own))
+            ci.pinned |= blockers;
+    }
+
+    if (ci.checkers) {
+        ci.evasion = std::popcount(ci.checkers) > 1
+            ? 0x00 : ci.checkers | movegen::between(kingSq, std::countr_zero(ci.checkers));
+    }
+
+    // the king must not hide behind itself on the attack line
+    const BB occNoKing = occ & ~kingMask;
+    ci.danger = movegen::getPawnAttacksM<Enemy>(enemyP)
+        | enemyAttacks_<Enemy, PKind::pN>(enemyN, occNoKing)
+        | enemyAttacks_<Enemy, PKind::pK>(enemy[PKind::pK], occNoKing)
+        | enemyAttacks_<Enemy, PKind::pB>(enemy[PKind::pB], occNoKing)
+        | enemyAttacks_<Enemy, PKind::pR>(enemy[PKind::pR], occNoKing)
+        | enemyAttacks_<Enemy, PKind::pQ>(enemy[PKind::pQ], occNoKing);
+
+    return ci;
+}
+
+
+void Board::put(PKind kind, PColor color, SQ sq) noexcept {
+    SG_ASSERT(kind != PKind::None);
 
-    if (!color) m_bb_col |= mask;
+    setPlanes_(qbb::kernel::put(planes_(), 1ull << sq, kind, color));
+    m_mailbox[sq] = kind;
 
     xorKey(m_key, color, kind, sq);
 }
 
 TEMPLATE_DEF_CONST(uint64_t, brd::Board::getPieceSqMask)
 TEMPLATE_DEF_CONST(void, brd::Board::movegen, MoveList&, const BoardState&)
+TEMPLATE_DEF_CONST(void, brd::Board::movegen, MoveList&, const BoardState&, const CheckInfo&)
+template CheckInfo Board::checkInfo<PColor::W>() const noexcept;
+template CheckInfo Board::checkInfo<PColor::B>() const noexcept;
+template bool Board::isLegal<PColor::W>(const Move&, const BoardState&, const CheckInfo&) const noexcept;
+template bool Board::isLegal<PColor::B>(const Move&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::W, MG_CAPTURES>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::W, MG_QUIETS>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::W, MG_ALL>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::B, MG_CAPTURES>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::B, MG_QUIETS>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
+template void Board::movegenStage<PColor::B, MG_ALL>(MoveList&, const BoardState&, const CheckInfo&) const noexcept;
 
 void Board::updateKey(uint8_t castling, bool isEnpass) noexcept {
     m_key ^= zobristSrc.blackToMove;
@@ -292,6 +591,7 @@ uint64_t Board::stateKey() const noexcept {
 
 void Board::clear() noexcept {
     m_bb_rqk = m_bb_pbq = m_bb_nbk = m_bb_col = 0x00;
+    std::fill(std::begin(m_mailbox), std::end(m_mailbox), PKind::None);
 }
 
 void Board::rebuildKey() noexcept {
@@ -2,6 +2,7 @@
 #define INCLUDE_BOARD_BOARD_H_
 #include "../core/defs.h"
 #include "movegen.h"
+#include "quad_bb.h"
 #include <utility>
 
 
@@ -10,9 +11,31 @@ namespace brd {
 #define BRD_SIZE 64u
 
 struct MoveList;
+struct Move;
 class BoardState;
 
 typedef uint64_t BrdKey_t;
+
+/*
+ * @brief   Legality data of the side to move, computed once per node
+ */
+struct CheckInfo {
+    BB checkers = 0x00;     // enemy pieces giving check
+    BB pinned = 0x00;       // own pieces pinned to the king
+    BB evasion = ~0x00ULL;  // allowed targets for non-king moves (block or capture the checker)
+    BB danger = 0x00;       // squares attacked by the enemy (the king removed from the occupancy)
+    SQ kingSq = SQ_CNT;     // SQ_CNT if there is no king on the board
+};
+
+/*
+ * @brief   Move generation stages
+ */
+enum MGType : uint8_t {
+    MG_CAPTURES = 0x01,     // captures, enpassant and promotions
+    MG_QUIETS = 0x02,       // the rest of moves including castling
+    MG_ALL = MG_CAPTURES | MG_QUIETS
+};
+
 class Board {
 public:
     explicit Board() noexcept;
@@ -56,9 +79,72 @@ public:
     void clear() noexcept;
 
     template <PColor Color, PKind Kind> void movegen(MoveList& mvList, const BoardState&) const noexcept;
+
+    /*
+     * @brief   Legal moves only, ci must be built by checkInfo<Color>() for the same position
+     */
+    template <PColor Color, PKind Kind>
+    void movegen(MoveList& mvList, const BoardState&, const CheckInfo& ci) const noexcept;
+
+    /*
+     * @brief   Legal moves of all the pieces for a single stage. The occupancy is computed once per call
+     */
+    template <PColor Color, MGType Type>
+    void movegenStage(MoveList& mvList, const BoardState&, const CheckInfo& ci) const noexcept;
+
+    /*
+     * @brief   Checkers, pinned pieces and evasion targets for the Color side
+     */
+    template<PColor Color> CheckInfo checkInfo() const noexcept;
+
+    /*
+     * @brief   Test that the move (i.e. from the TT) is a legal move of the Color side
+     */
+    template<PColor Color> bool isLegal(const Move&, const BoardState&, const CheckInfo& ci) const noexcept;
     template<PColor Color> BB attackMap(/* SQ sq */) const noexcept;
 
+    /*
+     * @brief   Pieces of both sides attacking the square, looked up from the square itself.
+     *          Sliders see through the pieces missing in the occupancy (x-rays for SEE)
+     */
+    BB attackersTo(SQ sq, BB occupied) const noexcept;
+    BB attackersTo(SQ sq) const noexcept;
+
+    /*
+     * @brief   Test that any piece of the byColor side attacks the square
+     */
+    bool isSquareAttacked(SQ sq, PColor byColor) const noexcept;
+
+    /*
+     * @brief   Static exchange evaluation of the move on its "to" square in PieceScores units
+     *          (x-rays are followed, pins and promotions are ignored)
+     */
+    Score see(const Move&) const noexcept;
+
+    /*
+     * @brief   see(move) >= threshold, stops as soon as the outcome is known
+     */
+    bool seeGE(const Move&, Score threshold) const noexcept;
+
+    /*
+     * @brief   The move takes a piece (enpassant included) or promotes a pawn
+     */
+    bool isCaptureOrPromo(const Move&) const noexcept;
+
+    /*
+     * @brief   All the 12 piece bitboards in one pass over the planes
+     */
+    PieceMasks pieceMasks() const noexcept;
+
+    /*
+     * @brief   Piece kind by a single square mask (None for an empty mask)
+     */
     PKind getKind(BB mask) const noexcept;
+
+    /*
+     * @brief   Piece kind on the square, a mailbox lookup
+     */
+    PKind kindAt(SQ sq) const noexcept;
     PColor getColor(BB mask) const noexcept;
     void put(PKind, PColor, SQ) noexcept;
 
@@ -74,16 +160,44 @@ public:
     [[nodiscard]] std::tuple<uint64_t, uint64_t, uint64_t, uint64_t> getRawBoard() const noexcept;
 
 private:
-    BB m_bb_col = 0xFFFF000000000000; // color
+    // the planes are kept adjacent and in the QuadBB order, so they load/store as one AVX2 register
+    alignas(32) BB m_bb_col = 0xFFFF000000000000; // color
     BB m_bb_pbq = 0x2CFF00000000FF2C; // P.B.Q
     BB m_bb_nbk = 0x7600000000000076; // N.B.K
     BB m_bb_rqk = 0x9900000000000099; // R.Q.K
     BrdKey_t m_key = 0;
+    PKind m_mailbox[BRD_SIZE + 1] {};    // kinds by square, the last one is a sentinel for an empty mask
+
+    void rebuildMailbox_() noexcept;
+
+    QuadBB planes_() const noexcept { return {m_bb_col, m_bb_pbq, m_bb_nbk, m_bb_rqk}; }
+    void setPlanes_(const QuadBB& q) noexcept;
 
     /*
      * @brief   Move square A -> B (by position mask)
      */
     PKind slideToM_(BB from, BB to) noexcept;
+
+    template <PColor Color, PKind Kind, bool Legal, MGType Type>
+    void movegen_(MoveList& mvList, const BoardState&, const CheckInfo& ci,
+                  BB occupied, BB enemyMask, BB fromMask = ~0x00ULL) const noexcept;
+
+    /*
+     * @brief   All the pawns at once: pushes, captures and promotions by shifts, enpassant by the last move
+     */
+    template <PColor Color, bool Legal, MGType Type>
+    void pawnMovegen_(MoveList& mvList, const BoardState&, const CheckInfo& ci,
+                      BB occupied, BB enemyMask, BB fromMask) const noexcept;
+
+    template <PColor Color> BB enemyMask_() const noexcept;
+
+    /*
+     * @brief   The least valuable piece among the attackers (0 if there are none)
+     */
+    BB leastValuable_(BB attackers, PKind& kind) const noexcept;
+
+    template <PColor Color>
+    bool enpassLegal_(SQ from, SQ to, const CheckInfo& ci) const noexcept;
 };
 
 
@@ -91,6 +205,30 @@ inline BB Board::occupancy() const noexcept {
     return m_bb_rqk | m_bb_pbq | m_bb_nbk;
 }
 
+inline void Board::setPlanes_(const QuadBB& q) noexcept {
+    m_bb_col = q.col;
+    m_bb_pbq = q.pbq;
+    m_bb_nbk = q.nbk;
+    m_bb_rqk = q.rqk;
+}
+
+inline PieceMasks Board::pieceMasks() const noexcept {
+    return qbb::kernel::pieceMasks(planes_());
+}
+
+inline PKind Board::kindAt(SQ sq) const noexcept {
+    return m_mailbox[sq];
+}
+
+inline PKind Board::getKind(BB mask) const noexcept {
+    return m_mailbox[std::countr_zero(mask)];
+}
+
+template <PColor Color> inline BB Board::enemyMask_() const noexcept {
+    if constexpr (Color) return m_bb_col;
+    else return ~m_bb_col;
+}
+
 
 template <PColor Color, PKind Kind>
 inline BB attackMap_(BB occ, const brd::Board& board, BB enemyMask) noexcept {
@@ -1,3 +1,5 @@
+#include <bit>
+#include <cstring>
 #include <optional>
 #include "board_state.h"
 #include "../dbg/sg_assert.h"
@@ -9,8 +11,6 @@
 #define CASTL_NEW_ROOK_POS(kingPos, castlType) (castlType == brd::CastlingType::C_SHORT ? (kingPos)+1 : (kingPos)-1)
 #define CASTL_ORIG_ROOK_POS(kingPos, castlType) ((castlType) == brd::CastlingType::C_SHORT ? (kingPos)+3 : (kingPos)-4)
 
-Score PieceScores[] = {PAWN_SCORE, DUMMY_SCORE, QUEEN_SCORE, BISHOP_SCORE, KNIGHT_SCORE};
-
 namespace brd {
 namespace details {
 template<PColor Color, PKind Kind>
@@ -34,90 +34,73 @@ struct MG<Color, PKind::pR> {
 };
 } // details
 
-static void switchMoveSideNN(BoardState::nnLayer_t& nn, PColor moveColor, bool undo) noexcept;
-
-static double getPieceId(PColor color, PKind kind) noexcept {
-    int a = static_cast<int>(kind);
-    return color ? static_cast<double>(a) : static_cast<double>(a + 6);
+static int8_t getPieceId(PColor color, PKind kind) noexcept {
+    int8_t a = static_cast<int8_t>(kind);
+    return color ? a : static_cast<int8_t>(a + 6);
 }
 
 template<std::size_t I>
 static void fillBits(auto& input, const auto& rawBrd, const brd::Board& board) noexcept {
     auto brdPart = std::get<I>(rawBrd);
     constexpr auto start = I*64;
-    for (SQ i=0; i<64; i++) {
-        BB mask = 1ull << i;
-        if (mask & brdPart) {
-            if constexpr (I == 0) {
-                input[start+i] = 1.0;
-            }
-            else {
-                input[start+i] = getPieceId(board.getColor(mask), board.getKind(mask));
-            }
+    while (brdPart) {
+        SQ i = popLsb(brdPart);
+        if constexpr (I == 0) {
+            input[start+i] = 1;
+        }
+        else {
+            BB mask = 1ull << i;
+            input[start+i] = getPieceId(board.getColor(mask), board.getKind(mask));
         }
     }
 }
 
 void rebuildNNLayer(const BoardState& state, BoardState::nnLayer_t& input) noexcept {
     const auto& rawBrd = state.getBoard().getRawBoard();
-    input.fill(0.0);
+    input.fill(0);
     fillBits<0>(input, rawBrd, state.getBoard());
     fillBits<1>(input, rawBrd, state.getBoard());
     fillBits<2>(input, rawBrd, state.getBoard());
     fillBits<3>(input, rawBrd, state.getBoard());
 
-    if (getNextPlayerColor(state))
-        input[256] = input[287] = 1.0;
+    // the FEN side to move is dropped by the first registerMove, take it from the last move then
+    const PColor next = state.ply() ? invert(static_cast<PColor>(state.getLastMove().moveColor))
+                                    : getNextPlayerColor(state);
+    if (next)
+        input[256] = input[287] = 1;
     else
-        input[288] = input[319] = 1.0;
+        input[288] = input[319] = 1;
 }
 
 BoardState::BoardState(brd::Board&& board) noexcept 
-: m_board(board) {
-    rebuildNNLayer(*this, m_nnLayer);
-}
+: m_pos{std::move(board)} {}
 
 
 BoardState::BoardState(const brd::BoardState& rhs) noexcept
-: m_board(rhs.m_board), m_undoList(rhs.m_undoList), m_rule50Ply(rhs.m_rule50Ply), m_wKingMoves(rhs.m_wKingMoves),
-m_bKingMoves(rhs.m_bKingMoves), m_wKingExists(rhs.m_wKingExists), m_bKingExists(rhs.m_bKingExists),
-m_lwRp(rhs.m_lwRp), m_lbRp(rhs.m_lbRp), m_lwRMoves(rhs.m_lwRMoves), m_rwRMoves(rhs.m_rwRMoves),
-m_lbRMoves(rhs.m_lbRMoves), m_rbRMoves(rhs.m_rbRMoves), m_fenEnpassMove(rhs.m_fenEnpassMove),
-m_fenNextPlayer(rhs.m_fenNextPlayer), m_buildFromFen(rhs.m_buildFromFen), m_fenCastlingMask(rhs.m_fenCastlingMask),
-m_nnLayer(rhs.m_nnLayer)
-{
-    m_nonPawnMaterial[0] = rhs.m_nonPawnMaterial[0];
-    m_nonPawnMaterial[1] = rhs.m_nonPawnMaterial[1];
-}
+: m_pos(rhs.m_pos), m_undoList(rhs.m_undoList), m_fenEnpassMove(rhs.m_fenEnpassMove),
+m_fenNextPlayer(rhs.m_fenNextPlayer), m_buildFromFen(rhs.m_buildFromFen), m_fenCastlingMask(rhs.m_fenCastlingMask)
+{}
 
 BoardState::BoardState(brd::BoardState&& rhs) noexcept
-: m_board(rhs.m_board), m_undoList(std::move(rhs.m_undoList)), m_rule50Ply(rhs.m_rule50Ply),
-  m_wKingMoves(rhs.m_wKingMoves), m_bKingMoves(rhs.m_bKingMoves), m_wKingExists(rhs.m_wKingExists),
-  m_bKingExists(rhs.m_bKingExists),
-  m_lwRp(rhs.m_lwRp), m_lbRp(rhs.m_lbRp), m_lwRMoves(rhs.m_lwRMoves), m_rwRMoves(rhs.m_rwRMoves),
-  m_lbRMoves(rhs.m_lbRMoves), m_rbRMoves(rhs.m_rbRMoves), m_fenEnpassMove(rhs.m_fenEnpassMove),
-  m_fenNextPlayer(rhs.m_fenNextPlayer), m_buildFromFen(rhs.m_buildFromFen), m_fenCastlingMask(rhs.m_fenCastlingMask),
-  m_nnLayer(rhs.m_nnLayer)
-{
-    m_nonPawnMaterial[0] = rhs.m_nonPawnMaterial[0];
-    m_nonPawnMaterial[1] = rhs.m_nonPawnMaterial[1];
-}
+: m_pos(rhs.m_pos), m_undoList(rhs.m_undoList), m_fenEnpassMove(rhs.m_fenEnpassMove),
+  m_fenNextPlayer(rhs.m_fenNextPlayer), m_buildFromFen(rhs.m_buildFromFen), m_fenCastlingMask(rhs.m_fenCastlingMask)
+{}
 
 void BoardState::updateRookMeta_(PColor color, SQ from, SQ to, bool inc) noexcept {
     int coeff = inc ? 1 : -1;
     if (color) {
-        if (from == m_lwRp) {
-            m_lwRp = to;
-            m_lwRMoves += coeff;
+        if (from == m_pos.lwRp) {
+            m_pos.lwRp = to;
+            m_pos.lwRMoves += coeff;
         }
-        else m_rwRMoves += coeff;
+        else m_pos.rwRMoves += coeff;
     }
     else {
-        if (from == m_lbRp) {
-            m_lbRp = to;
-            m_lbRMoves += coeff;
+        if (from == m_pos.lbRp) {
+            m_pos.lbRp = to;
+            m_pos.lbRMoves += coeff;
         }
-        else m_rbRMoves += coeff;
+        else m_pos.rbRMoves += coeff;
     }
 }
 
@@ -128,19 +111,19 @@ void BoardState::registerMove(const Move& move) noexcept {
     PKind moveKind = PKind::None;
 
     BB fromMask = 1ull << move.from, toMask = 1ull << move.to;
-    auto moveColor = m_board.getColor(fromMask);
+    auto moveColor = m_pos.board.getColor(fromMask);
 
-    bool isCapture = !m_board.emptyM(toMask) && !move.castling;
+    bool isCapture = !m_pos.board.emptyM(toMask) && !move.castling;
     SQ enpassVictimPos = 0x00;
     if (move.isEnpass) {
         enpassVictimPos = (moveColor == PColor::W ? move.to - 8 : move.to + 8);
-        auto [c, k] = m_board.kill(enpassVictimPos);
+        auto [c, k] = m_pos.board.kill(enpassVictimPos);
         SG_ASSERT(c != moveColor);
         capturedKind = k;
         moveKind = PKind::pP;
     }
     else if (isCapture) {
-        auto [color, kind] = m_board.kill(move.to);
+        auto [color, kind] = m_pos.board.kill(move.to);
         capturedKind = kind;
     }
 
@@ -150,42 +133,43 @@ void BoardState::registerMove(const Move& move) noexcept {
         newKPos = CASTL_NEW_KING_POS(move.from, move.castling);
         newRPos = CASTL_NEW_ROOK_POS(move.from, move.castling);
         rPos = CASTL_ORIG_ROOK_POS(move.from, move.castling);
-        m_board.slideTo(move.from, newKPos);
-        m_board.slideTo(rPos, newRPos);
+        m_pos.board.slideTo(move.from, newKPos);
+        m_pos.board.slideTo(rPos, newRPos);
         moveKind = PKind::pK;
     }
     else {
-        moveKind = m_board.slideTo(move.from, move.to);
+        moveKind = m_pos.board.slideTo(move.from, move.to);
 
         // test for the Promotion
         if(moveKind == PKind::pP && !move.isEnpass) {
-            auto col = m_board.getColor(toMask);
+            auto col = m_pos.board.getColor(toMask);
             if ((col == PColor::W && toMask & NRank::r8)
                     || (col == PColor::B && toMask & NRank::r1)) {
                 promo = true;
-                m_board.kill(move.to);
-                m_board.put(PKind::pQ, moveColor, move.to);
-                m_nonPawnMaterial[col2int(moveColor)] -= PieceScores[static_cast<unsigned>(PKind::pP)];
-                m_nonPawnMaterial[col2int(moveColor)] += PieceScores[static_cast<unsigned>(PKind::pQ)];
+                m_pos.board.kill(move.to);
+                m_pos.board.put(PKind::pQ, moveColor, move.to);
+                m_pos.nonPawnMaterial[col2int(moveColor)] -= PieceScores[static_cast<unsigned>(PKind::pP)];
+                m_pos.nonPawnMaterial[col2int(moveColor)] += PieceScores[static_cast<unsigned>(PKind::pQ)];
             }
         }
     }
-    m_board.updateKey(move.castling, move.isEnpass);
+    m_pos.board.updateKey(move.castling, move.isEnpass);
 
     undoRec_ rec = buildUndoRec_(move, moveKind, capturedKind, promo, moveColor);
+    reserveHistory_();
     m_undoList.emplace_back(rec);
-    if(!isCapture && moveKind != PKind::pP) m_rule50Ply++;
-    else m_rule50Ply = 0;
+    if(!isCapture && moveKind != PKind::pP) m_pos.rule50Ply++;
+    else m_pos.rule50Ply = 0;
 
     if (move.castling || moveKind == PKind::pK) {
-        if (moveColor == PColor::W) m_wKingMoves++;
-        else m_bKingMoves++;
+        if (moveColor == PColor::W) m_pos.wKingMoves++;
+        else m_pos.bKingMoves++;
     }
 
     if (capturedKind == PKind::pK)
         setKingExistence_(invert(moveColor), false);
     else if (!promo && capturedKind != PKind::None)
-        m_nonPawnMaterial[col2int(invert(moveColor))] -= PieceScores[static_cast<unsigned>(capturedKind)];
+        m_pos.nonPawnMaterial[col2int(invert(moveColor))] -= PieceScores[static_cast<unsigned>(capturedKind)];
 
     // update dedicated rook position vars for castle handling
     if (moveKind == PKind::pR)
@@ -194,148 +178,18 @@ void BoardState::registerMove(const Move& move) noexcept {
         updateRookMeta_(moveColor, rPos, newRPos, true);
 
     FenResetState();
-
-    updateNN_(rec, newRPos, rPos, newKPos, enpassVictimPos, false);
-}
-
-
-static void switchMoveSideNN(BoardState::nnLayer_t& nn, PColor moveColor, bool undo) noexcept {
-    double f = 1.0, s = 0.0;
-    if ((moveColor && !undo) || (!moveColor && undo))
-        std::swap(f, s);
-
-    nn[256] = nn[287] = f;
-    nn[288] = nn[319] = s;
-}
-
-void BoardState::updateNN_(brd::BoardState::undoRec_ rec, SQ newRPos, SQ rPos, SQ newKPos, SQ enpassPos, bool undo) noexcept {
-    auto mvColor = static_cast<PColor>(rec.moveColor);
-    if (rec.castling) {
-        SQ kPos = rec.from;
-        if (undo) {
-            std::swap(kPos, newKPos);
-            std::swap(rPos, newRPos);
-        }
-
-        m_nnLayer[64 + kPos] = m_nnLayer[192 + kPos] = 0.0;
-        m_nnLayer[64 + newKPos] = m_nnLayer[192 + newKPos] = getPieceId(mvColor, PKind::pK);
-
-        m_nnLayer[192 + rPos] = 0.0;
-        m_nnLayer[192 + newRPos] = getPieceId(mvColor, PKind::pR);;
-
-        if (!mvColor) {
-            m_nnLayer[kPos] = m_nnLayer[rPos] = 0.0;
-            m_nnLayer[newKPos] = m_nnLayer[newRPos] = 1.0;
-        }
-        switchMoveSideNN(m_nnLayer, static_cast<PColor>(rec.moveColor), undo);
-        return;
-    }
-
-    SQ from = rec.from, to = rec.to;
-    auto ck = static_cast<PKind>(rec.capturedKind);
-
-    if (ck != PKind::None) {
-        double flag = undo ? getPieceId(invert(mvColor), ck) : 0.0;
-        switch (ck) {
-            case PKind::pP: {
-                if (rec.isEnpass) m_nnLayer[128 + enpassPos] = flag;
-                else m_nnLayer[128 + to] = flag;
-                break;
-            }
-            case PKind::pK: {
-                m_nnLayer[64 + to] = m_nnLayer[192 + to] = flag;
-                break;
-            }
-            case PKind::pR: {
-                m_nnLayer[192 + to] = flag;
-                break;
-            }
-            case PKind::pQ: {
-                m_nnLayer[128 + to] = m_nnLayer[192 + to] = flag;
-                break;
-            }
-            case PKind::pB: {
-                m_nnLayer[64 + to] = m_nnLayer[128 + to] = flag;
-                break;
-            }
-            case PKind::pN: {
-                m_nnLayer[64 + to] = flag;
-                break;
-            }
-            case PKind::None: break;
-        }
-        if (mvColor) {
-            // black was killed
-            if (rec.isEnpass) {
-                SG_ASSERT(enpassPos);
-                SG_ASSERT((undo && m_nnLayer[enpassPos] == 0.) || (!undo && m_nnLayer[enpassPos] == 1.));
-                m_nnLayer[enpassPos] = undo ? 1.0 : 0.0;
-            }
-            else m_nnLayer[to] = undo ? 1.0 : 0.0;
-        }
-    }
-
-    if (undo) std::swap(from, to);
-
-    auto mvKind = static_cast<PKind>(rec.moveKind);
-    auto pieceId = getPieceId(mvColor, mvKind);
-    SG_ASSERT(mvKind != PKind::None)
-
-    switch (mvKind) {
-        case PKind::pP: {
-            m_nnLayer[128 + from] = 0.0;
-            m_nnLayer[128 + to] = pieceId;
-            break;
-        }
-        case PKind::pK: {
-            m_nnLayer[64 + from] = m_nnLayer[192 + from] = 0.0;
-            m_nnLayer[64 + to] = m_nnLayer[192 + to] = pieceId;
-            break;
-        }
-        case PKind::pR: {
-            m_nnLayer[192 + from] = 0.0;
-            m_nnLayer[192 + to] = pieceId;
-            break;
-        }
-        case PKind::pQ: {
-            m_nnLayer[128 + from] = m_nnLayer[192 + from] = 0.0;
-            m_nnLayer[128 + to] = m_nnLayer[192 + to] = pieceId;
-            break;
-        }
-        case PKind::pB: {
-            m_nnLayer[64 + from] = m_nnLayer[128 + from] = 0.0;
-            m_nnLayer[64 + to] = m_nnLayer[128 + to] = pieceId;
-            break;
-        }
-        case PKind::pN: {
-            m_nnLayer[64 + from] = 0.0;
-            m_nnLayer[64 + to] = pieceId;
-            break;
-        }
-        default: break;
-    }
-
-    if (rec.promo) {
-        m_nnLayer[128 + to] = m_nnLayer[192 + to] = undo ? 0.0 : getPieceId(mvColor, PKind::pQ);
-    }
-
-    if (!mvColor) {
-        m_nnLayer[from] = 0.0;
-        m_nnLayer[to] = 1.0;
-    }
-
-    switchMoveSideNN(m_nnLayer, static_cast<PColor>(rec.moveColor), undo);
+    m_nnDirty = true;
 }
 
 
 void BoardState::movegen(MoveList& mvList) noexcept {
     if (gameover()) return;
-    details::MG<PColor::W, PKind::pP>{}.run(m_board, mvList, *this);
+    details::MG<PColor::W, PKind::pP>{}.run(m_pos.board, mvList, *this);
 }
 
 
 void BoardState::undo() noexcept {
-    undoRec_ rec = m_undoList.back();; m_undoList.pop_back();
+    undoRec_ rec = m_undoList.back(); m_undoList.pop_back();
 
     auto from = static_cast<SQ>(rec.from);
     auto to = static_cast<SQ>(rec.to);
@@ -354,40 +208,40 @@ void BoardState::undo() noexcept {
         kPos = CASTL_NEW_KING_POS(from, castle);
         rPos = CASTL_NEW_ROOK_POS(from, castle);
         origRPos = CASTL_ORIG_ROOK_POS(from, castle);
-        m_board.slideTo(kPos, from);
-        m_board.slideTo(rPos, origRPos);
-        moveColor = m_board.getColor(fromMask);
+        m_pos.board.slideTo(kPos, from);
+        m_pos.board.slideTo(rPos, origRPos);
+        moveColor = m_pos.board.getColor(fromMask);
     }
     else {
-        moveColor = m_board.getColor(toMask);
-        m_board.slideTo(to, from);
+        moveColor = m_pos.board.getColor(toMask);
+        m_pos.board.slideTo(to, from);
         if (capturedKind != PKind::None) {
             if(isEnpass) {
                 enpassVictimSq = moveColor == PColor::W ? to - 8 : to + 8;
-                m_board.put(capturedKind, invert(moveColor), enpassVictimSq);
+                m_pos.board.put(capturedKind, invert(moveColor), enpassVictimSq);
             }
-            else m_board.put(capturedKind, invert(moveColor), to);
+            else m_pos.board.put(capturedKind, invert(moveColor), to);
         }
         if (promo) {
             // handle only the case P -> Q
-            m_board.kill(from);
-            m_board.put(PKind::pP, moveColor, from);
-            m_nonPawnMaterial[col2int(moveColor)] += PieceScores[static_cast<unsigned>(PKind::pP)];
-            m_nonPawnMaterial[col2int(moveColor)] -= PieceScores[static_cast<unsigned>(PKind::pQ)];
+            m_pos.board.kill(from);
+            m_pos.board.put(PKind::pP, moveColor, from);
+            m_pos.nonPawnMaterial[col2int(moveColor)] += PieceScores[static_cast<unsigned>(PKind::pP)];
+            m_pos.nonPawnMaterial[col2int(moveColor)] -= PieceScores[static_cast<unsigned>(PKind::pQ)];
         }
     }
 
-    m_board.updateKey(castle, isEnpass);
-    m_rule50Ply = rule50;
+    m_pos.board.updateKey(castle, isEnpass);
+    m_pos.rule50Ply = rule50;
     if (castle || moveKind == PKind::pK) {
-        if (moveColor == PColor::W) m_wKingMoves--;
-        else m_bKingMoves--;
+        if (moveColor == PColor::W) m_pos.wKingMoves--;
+        else m_pos.bKingMoves--;
     }
 
     if (capturedKind == PKind::pK)
         setKingExistence_(invert(moveColor), true);
     else if (!promo && capturedKind != PKind::None)
-        m_nonPawnMaterial[col2int(invert(moveColor))] += PieceScores[static_cast<unsigned>(capturedKind)];
+        m_pos.nonPawnMaterial[col2int(invert(moveColor))] += PieceScores[static_cast<unsigned>(capturedKind)];
 
     if (moveKind == PKind::pR)
         updateRookMeta_(moveColor, to, from, false);
@@ -395,8 +249,39 @@ void BoardState::undo() noexcept {
         updateRookMeta_(moveColor, rPos, origRPos, false);
 
     FenSetEnpass(0x00);
+    m_nnDirty = true;
+}
 
-    updateNN_(rec, rPos, origRPos, kPos, enpassVictimSq, true);
+void BoardState::makeNull() noexcept {
+    const PColor color = ply() ? invert(static_cast<PColor>(getLastMove().moveColor))
+                               : getNextPlayerColor(*this);
+    Move null{};
+    null.isNull = 1;
+    // moveKind None: the side of the record is all that the next move generation looks at
+    reserveHistory_();
+    m_undoList.emplace_back(buildUndoRec_(null, PKind::None, PKind::None, false, color));
+    m_pos.board.updateKey(0x00, false);
+    m_nnDirty = true;
+}
+
+void BoardState::reserveHistory_() noexcept {
+    // games longer than MAX_HISTORY_PLY lose their oldest moves, which no search ever undoes.
+    // An even count keeps the side to move derived from the history size
+    if (m_undoList.full()) m_undoList.drop_front(2);
+}
+
+void BoardState::undoNull() noexcept {
+    SG_ASSERT(ply() && getLastMove().isNull);
+    m_undoList.pop_back();
+    m_pos.board.updateKey(0x00, false);
+    m_nnDirty = true;
+}
+
+void BoardState::restore(const Position& pos) noexcept {
+    m_undoList.pop_back();
+    std::memcpy(static_cast<void*>(&m_pos), &pos, sizeof(Position));
+    FenSetEnpass(0x00);
+    m_nnDirty = true;
 }
 
 std::size_t BoardState::ply() const noexcept {
@@ -408,24 +293,54 @@ bool BoardState::gameover() const noexcept {
 }
 
 Score BoardState::nonPawnMaterial(PColor color) const noexcept {
-    return m_nonPawnMaterial[col2int(color)];
+    return m_pos.nonPawnMaterial[col2int(color)];
+}
+
+template<PColor Color>
+static Score pieceMaterialOf(const Board& board) noexcept {
+    return static_cast<Score>(std::popcount(board.getPieceSqMask<Color, PKind::pN>()) * KNIGHT_SCORE
+                            + std::popcount(board.getPieceSqMask<Color, PKind::pB>()) * BISHOP_SCORE
+                            + std::popcount(board.getPieceSqMask<Color, PKind::pR>()) * ROOK_SCORE
+                            + std::popcount(board.getPieceSqMask<Color, PKind::pQ>()) * QUEEN_SCORE);
+}
+
+template<PColor Color>
+static Score materialOf(const Board& board) noexcept {
+    return static_cast<Score>(pieceMaterialOf<Color>(board)
+                            + std::popcount(board.getPieceSqMask<Color, PKind::pP>()) * PAWN_SCORE);
+}
+
+Score BoardState::pieceMaterial(PColor color) const noexcept {
+    // by the bitboards, the material counters hold the pawns too
+    return color ? pieceMaterialOf<PColor::W>(m_pos.board) : pieceMaterialOf<PColor::B>(m_pos.board);
 }
 
 bool BoardState::checkmate(PColor color) const noexcept {
-    return color ? !m_wKingExists : !m_bKingExists;
+    return color ? !m_pos.wKingExists : !m_pos.bKingExists;
 }
 
 void BoardState::setKingExistence_(PColor color, bool exists) noexcept {
-    auto& k = color ? m_wKingExists : m_bKingExists;
+    auto& k = color ? m_pos.wKingExists : m_pos.bKingExists;
     k = exists;
 }
 
 void BoardState::resetState(unsigned rule50) noexcept {
-    {
-        decltype(m_undoList) tmp{};
-        m_undoList.swap(tmp);
-    }
-    m_rule50Ply = rule50;
+    m_undoList.clear();
+    m_pos.rule50Ply = rule50;
+    // the board is set up from scratch (FEN), the material is counted over
+    m_pos.nonPawnMaterial[col2int(PColor::W)] = materialOf<PColor::W>(m_pos.board);
+    m_pos.nonPawnMaterial[col2int(PColor::B)] = materialOf<PColor::B>(m_pos.board);
+}
+
+void BoardState::setupStartPosition() noexcept {
+    const Position start;
+    std::memcpy(static_cast<void*>(&m_pos), &start, sizeof(Position));
+    m_undoList.clear();
+    m_fenEnpassMove = 0x00;
+    m_fenNextPlayer.reset();
+    m_buildFromFen = false;
+    m_fenCastlingMask = 0x00;
+    m_nnDirty = true;
 }
 
 const BoardState::undoList_t& BoardState::history() const noexcept {
@@ -433,7 +348,7 @@ const BoardState::undoList_t& BoardState::history() const noexcept {
 }
 
 bool BoardState::draw() const noexcept {
-    return m_rule50Ply > 50;
+    return m_pos.rule50Ply > 50;
 }
 
 
@@ -454,19 +369,19 @@ unsigned BoardState::PG_possibleCastlMask() const noexcept {
 
 bool BoardState::validateEnpassPosition(SQ enpassSQ, SQ pawnPos) const noexcept {
     BB pawnMask = 1ull << pawnPos;
-    PColor pawnColor = m_board.getColor(pawnMask);
+    PColor pawnColor = m_pos.board.getColor(pawnMask);
 
-    if (!m_board.empty(enpassSQ)) return 0x00;
+    if (!m_pos.board.empty(enpassSQ)) return 0x00;
     BB toLeftMask = 1ull << (pawnPos-1);
-    auto leftKind = m_board.getKind(toLeftMask);
+    auto leftKind = m_pos.board.getKind(toLeftMask);
     if (!(pawnMask & NFile::fA)
-        && (leftKind == None || (leftKind == PKind::pP && pawnColor != m_board.getColor(toLeftMask))))
+        && (leftKind == None || (leftKind == PKind::pP && pawnColor != m_pos.board.getColor(toLeftMask))))
         return true;
 
     BB toRightMask = 1ull << (pawnPos+1);
-    auto rightKind = m_board.getKind(toRightMask);
+    auto rightKind = m_pos.board.getKind(toRightMask);
     if (!(pawnMask & NFile::fH)
-        && (rightKind == None || (rightKind == PKind::pP && pawnColor != m_board.getColor(toRightMask))))
+        && (rightKind == None || (rightKind == PKind::pP && pawnColor != m_pos.board.getColor(toRightMask))))
         return true;
 
     return false;
@@ -484,9 +399,9 @@ SQ BoardState::PG_enpassPos() const noexcept {
 
 
     BB toMask = 1ull << to;
-    PColor moveColor = m_board.getColor(toMask);
+    PColor moveColor = m_pos.board.getColor(toMask);
 
-    BB mask = moveColor ? m_board.getPieceSqMask<PColor::B, PKind::pP>() : m_board.getPieceSqMask<PColor::W, PKind::pP>();
+    BB mask = moveColor ? m_pos.board.getPieceSqMask<PColor::B, PKind::pP>() : m_pos.board.getPieceSqMask<PColor::W, PKind::pP>();
     while (mask) {
         SQ sq = popLsb(mask);
         auto rr = moveColor ?
@@ -546,7 +461,7 @@ BoardState::undoRec_ BoardState::buildUndoRec_(
     rec.to = move.to;
     rec.moveKind = moveKind;
     rec.isNull = move.isNull;
-    rec.rule50ply = m_rule50Ply;
+    rec.rule50ply = m_pos.rule50Ply;
     rec.capturedKind = capturedKind;
     rec.castling = move.castling;
     rec.promo = promo;
@@ -566,7 +481,7 @@ PColor getNextPlayerColor(const brd::BoardState& state) noexcept {
 
 bool BoardState::is_promo(const brd::Move& move) const {
     BB fromMask = AS_BB(move.from);
-    PKind kind = m_board.getKind(fromMask);
+    PKind kind = m_pos.board.getKind(fromMask);
     if (kind != PKind::pP || move.isEnpass) return false;
     BB toMask = AS_BB(move.to);
     return toMask & NRank::r1 || toMask & NRank::r8;
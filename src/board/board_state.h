@@ -1,16 +1,33 @@
 #ifndef INCLUDE_BOARD_BOARD_STATE_H_
 #define INCLUDE_BOARD_BOARD_STATE_H_
-#include <deque>
 #include <vector>
 #include <optional>
 #include "move.h"
 #include "../core/defs.h"
 #include "board.h"
 #include "../core/scores.h"
+#include "../core/inplace_stack.h"
 #include <array>
+#include <type_traits>
 
 namespace common { struct Options; }
 namespace brd {
+
+/*
+ * @brief   Everything registerMove changes except the undo list and the lazy NN layer.
+ *          Trivially copyable: saving and restoring it is a plain memcpy of 160 bytes
+ */
+struct Position {
+    Board       board;
+    Score       nonPawnMaterial[2] = {INIT_MATERIAL, INIT_MATERIAL};
+    uint16_t    wKingMoves = 0, bKingMoves = 0;
+    uint16_t    lwRMoves = 0, rwRMoves = 0, lbRMoves = 0, rbRMoves = 0; // left/right black/white rook moves count
+    SQ          lwRp = SqNum::sqn_a1, lbRp = SqNum::sqn_a8;             // left black and white rook positions
+    uint8_t     rule50Ply = 0;
+    bool        wKingExists = true, bKingExists = true;
+};
+static_assert(std::is_trivially_copyable_v<Position>, "Position is copied with memcpy");
+
 class BoardState {
 /** Undo move records. 32 bits packed */
 struct undoRec_ {
@@ -36,24 +53,50 @@ public:
     BoardState& operator=(const BoardState&) = delete;
     BoardState& operator=(BoardState&&) = delete;
 
-    typedef std::deque<undoRec_> undoList_t;
+    // the whole game history plus the search line, 4 bytes per ply
+    constexpr static std::size_t MAX_HISTORY_PLY = 1024;
+    typedef InplaceStack<undoRec_, MAX_HISTORY_PLY> undoList_t;
     void movegen(MoveList& mvList) noexcept;
     template<PColor Color, PKind Kind> void movegenFor(MoveList& mvList) noexcept;
     template<PColor Color> void movegenFor(MoveList& mvList) const noexcept;
+
+    /*
+     * @brief   Generate legal moves only (pins, checks and evasions are resolved once per call)
+     * @return  Check info of the Color side. No moves plus checkers means checkmate, otherwise stalemate
+     */
+    template<PColor Color> CheckInfo legalMovegenFor(MoveList& mvList) const noexcept;
     void registerMove(const Move&) noexcept;
 
     void undo() noexcept;
 
+    /*
+     * @brief   Null move: the side to move passes. The Zobrist key and the NN side flags flip,
+     *          enpassant isn't possible after it. undoNull takes it back
+     */
+    void makeNull() noexcept;
+    void undoNull() noexcept;
+
+    /*
+     * @brief   Copy-make support: take the position before registerMove and hand it back
+     *          instead of undo(). The move record is popped, the rest is copied back
+     */
+    const Position& position() const noexcept;
+    void restore(const Position&) noexcept;
+
     /*
      * @brief   Return non-mutable board
      */
     const Board& getBoard() const noexcept;
 
     /*
-     * @brief   Return mutable board
+     * @brief   Return mutable board, the NN layer is rebuilt on the next getNNL()
      */
     Board& getBoardMutable() noexcept;
     const undoRec_& getLastMove() const noexcept;
+    /*
+     * @brief   The records in the undo list: a game longer than MAX_HISTORY_PLY loses its
+     *          oldest ones, ply() doesn't count all the plies played then
+     */
     std::size_t ply() const noexcept;
     bool gameover() const noexcept;
     bool draw() const noexcept;
@@ -69,8 +112,23 @@ public:
      */
     Score nonPawnMaterial(PColor) const noexcept;
 
+    /*
+     * @brief   Material of the pieces, the pawns and the king aside
+     */
+    Score pieceMaterial(PColor) const noexcept;
+
+    /*
+     * @brief   Starts the history over on the current board: the undo list is cleared,
+     *          the material is counted from the board
+     */
     void resetState(unsigned rule50) noexcept;
 
+    /*
+     * @brief   The start position with an empty history, whatever was played before
+     *          (the dropped records of a long game included)
+     */
+    void setupStartPosition() noexcept;
+
     /*
      * @brief   Indicates that the castling still possible (even if the king under check)
      */
@@ -83,7 +141,12 @@ public:
     bool is_promo(const brd::Move&) const;
 
     // ========= NN ==============
-    using nnLayer_t = std::array<double, 320>;
+    // 4 board planes of piece ids (0 empty, 1-6 white, 7-12 black) plus the side to move,
+    // int8 keeps it at 320 bytes and the evaluator skips the zero entries
+    using nnLayer_t = std::array<int8_t, 320>;
+    /*
+     * @brief   NN input of the current position, rebuilt on the first call after the position changed
+     */
     const nnLayer_t& getNNL() const noexcept;
     // ========= NN ==============
 
@@ -107,100 +170,122 @@ public:
 
 
 private:
-    brd::Board              m_board;
+    Position                m_pos;
     /** Move records list for undo operations and previous move analyzing */
     mutable undoList_t      m_undoList;
-    uint8_t                 m_rule50Ply = 0;
-    unsigned int            m_wKingMoves = 0, m_bKingMoves = 0;
-    Score                   m_nonPawnMaterial[2] = {INIT_MATERIAL, INIT_MATERIAL};
-    unsigned                m_wKingExists = true, m_bKingExists = true;
-    SQ                      m_lwRp = SqNum::sqn_a1, m_lbRp = SqNum::sqn_a8; // left black and white rook positions
-    unsigned int            m_lwRMoves=0, m_rwRMoves=0, m_lbRMoves=0, m_rbRMoves=0; // left/right black/white rook moves count
     SQ                      m_fenEnpassMove=0;
     std::optional<PColor>   m_fenNextPlayer;
     bool                    m_buildFromFen = false;
     uint64_t                m_fenCastlingMask = 0x00;
-    nnLayer_t               m_nnLayer{};
+    // built on demand by getNNL(), forks and make/unmake only mark it dirty
+    mutable nnLayer_t       m_nnLayer;
+    mutable bool            m_nnDirty = true;
 
 
     void setKingExistence_(PColor, bool) noexcept;
+    void reserveHistory_() noexcept;
     void updateRookMeta_(PColor color, SQ from, SQ to, bool inc) noexcept;
     undoRec_ buildUndoRec_(const brd::Move& move, PKind moveKind,
                            PKind capturedKind, bool promo, PColor moveColor) noexcept;
-
-    void updateNN_(undoRec_ rec, SQ newRPos, SQ rPos, SQ newKPos, SQ enpassPos, bool undo) noexcept;
 };
 
 inline const BoardState::undoRec_& BoardState::getLastMove() const noexcept {
     return m_undoList.back();
 }
 
-inline const BoardState::nnLayer_t& BoardState::getNNL() const noexcept {
-    return m_nnLayer;
+inline const Position& BoardState::position() const noexcept {
+    return m_pos;
 }
 
 template <PColor Color, PKind Kind>
 void BoardState::movegenFor(MoveList& mvList) noexcept {
     if (gameover()) return;
-    m_board.movegen<Color, Kind>(mvList, *this);
+    m_pos.board.movegen<Color, Kind>(mvList, *this);
 }
 
 template <PColor Color>
 void BoardState::movegenFor(MoveList& mvList) const noexcept {
     if (gameover()) return;
-    m_board.movegen<Color, PKind::pK>(mvList, *this);
-    m_board.movegen<Color, PKind::pB>(mvList, *this);
-    m_board.movegen<Color, PKind::pQ>(mvList, *this);
-    m_board.movegen<Color, PKind::pP>(mvList, *this);
-    m_board.movegen<Color, PKind::pN>(mvList, *this);
-    m_board.movegen<Color, PKind::pR>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pK>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pB>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pQ>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pP>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pN>(mvList, *this);
+    m_pos.board.movegen<Color, PKind::pR>(mvList, *this);
+}
+
+template <PColor Color>
+CheckInfo BoardState::legalMovegenFor(MoveList& mvList) const noexcept {
+    if (gameover()) return {};
+    auto ci = m_pos.board.checkInfo<Color>();
+    m_pos.board.movegenStage<Color, MG_ALL>(mvList, *this, ci);
+    return ci;
 }
 
 inline const Board& BoardState::getBoard() const noexcept {
-    return m_board;
+    return m_pos.board;
 }
 
 inline Board& BoardState::getBoardMutable() noexcept {
-    return m_board;
+    m_nnDirty = true;
+    return m_pos.board;
 }
 
 template<PColor Color> bool BoardState::kindNotMoved() const noexcept {
     if constexpr (Color == PColor::W) {
-        return !m_wKingMoves;
+        return !m_pos.wKingMoves;
     }
     else {
-        return !m_bKingMoves;
+        return !m_pos.bKingMoves;
     }
 }
 
 template<PColor Color> bool BoardState::leftRookNotMoved() const noexcept {
     if constexpr (Color == PColor::W) {
-        return !m_lwRMoves;
+        return !m_pos.lwRMoves;
     }
     else {
-        return !m_lbRMoves;
+        return !m_pos.lbRMoves;
     }
 }
 
 template<PColor Color> bool BoardState::rightRookNotMoved() const noexcept {
     if constexpr (Color == PColor::W) {
-        return !m_rwRMoves;
+        return !m_pos.rwRMoves;
     }
     else {
-        return !m_rbRMoves;
+        return !m_pos.rbRMoves;
     }
 }
 
 template<PColor Color> bool BoardState::kingUnderCheck() const noexcept {
-    if constexpr (Color) {
-        auto kingMask = m_board.getPieceSqMask<PColor::W, PKind::pK>();
-        return kingMask & m_board.attackMap<PColor::B>();
+    constexpr PColor Enemy = Color == PColor::W ? PColor::B : PColor::W;
+    const BB kingMask = m_pos.board.getPieceSqMask<Color, PKind::pK>();
+    return kingMask && m_pos.board.isSquareAttacked(std::countr_zero(kingMask), Enemy);
+}
+
+/*
+ * @brief   Make/unmake policies for the tree walkers (perft, search).
+ *          MakeUnmake reverses the move from its undo record, CopyMake copies the saved position back
+ */
+struct MakeUnmake {
+    struct Saved {};
+    static Saved make(BoardState& state, const Move& move) noexcept {
+        state.registerMove(move);
+        return {};
     }
-    else {
-        auto kingMask = m_board.getPieceSqMask<PColor::B, PKind::pK>();
-        return kingMask & m_board.attackMap<PColor::W>();
+    static void unmake(BoardState& state, const Saved&) noexcept { state.undo(); }
+};
+
+struct CopyMake {
+    using Saved = Position;
+    static Saved make(BoardState& state, const Move& move) noexcept {
+        Saved saved = state.position();
+        state.registerMove(move);
+        return saved;
     }
-}
+    static void unmake(BoardState& state, const Saved& saved) noexcept { state.restore(saved); }
+};
 
 PColor getNextPlayerColor(const brd::BoardState& state) noexcept;
 
@@ -210,5 +295,13 @@ constexpr std::size_t nnLayerSize() {
 
 void rebuildNNLayer(const BoardState& state, BoardState::nnLayer_t& input) noexcept;
 
+inline const BoardState::nnLayer_t& BoardState::getNNL() const noexcept {
+    if (m_nnDirty) {
+        rebuildNNLayer(*this, m_nnLayer);
+        m_nnDirty = false;
+    }
+    return m_nnLayer;
+}
+
 } // namespace brd
 #endif  // INCLUDE_BOARD_BOARD_STATE_H_
@@ -3,6 +3,7 @@
 
 #include <cstdint>
 #include <ostream>
+#include <utility>
 #include "../core/defs.h"
 
 namespace brd {
@@ -85,6 +86,7 @@ struct MoveList {
     Move pop() noexcept;
     std::size_t size() const noexcept;
     const Move& operator[](std::size_t i) noexcept;
+    void swap(std::size_t i, std::size_t j) noexcept;
 
 private:
     std::size_t m_ptr = 0;
@@ -99,6 +101,10 @@ inline const Move& MoveList::operator[](std::size_t i) noexcept {
     return m_data[i];
 }
 
+inline void MoveList::swap(std::size_t i, std::size_t j) noexcept {
+    std::swap(m_data[i], m_data[j]);
+}
+
 class Board;
 brd::Move recognizeMove(SQ from, SQ to, const brd::Board&) noexcept;
 
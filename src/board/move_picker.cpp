@@ -0,0 +1,125 @@
+#include "move_picker.h"
+#include "board_state.h"
+#include "../core/scores.h"
+#include <algorithm>
+#include <cstdint>
+
+
+namespace brd {
+
+MovePicker::MovePicker(const BoardState& state, PColor color, Move hashMove, MGType type,
+                       const QuietHints& hints) noexcept
+: m_state(state), m_color(color), m_hashMove(hashMove), m_type(type), m_hints(hints) {
+    if (m_state.gameover()) {
+        m_stage = ST_DONE;
+        return;
+    }
+
+    auto&& board = m_state.getBoard();
+    m_ci = color ? board.checkInfo<PColor::W>() : board.checkInfo<PColor::B>();
+    // evasions can't be limited to the captures
+    if (m_ci.checkers) m_type = MG_ALL;
+    if (m_type == MG_CAPTURES && !m_hashMove.NAM() && !board.isCaptureOrPromo(m_hashMove))
+        m_hashMove = NONE_MOVE;
+
+    bool legal = !m_hashMove.NAM() && (color
+        ? board.isLegal<PColor::W>(m_hashMove, m_state, m_ci)
+        : board.isLegal<PColor::B>(m_hashMove, m_state, m_ci));
+    if (!legal) m_hashMove = NONE_MOVE;
+}
+
+template<MGType Type>
+void MovePicker::generate_() noexcept {
+    m_moves = MoveList{};
+    m_idx = 0;
+    if (m_color) m_state.getBoard().movegenStage<PColor::W, Type>(m_moves, m_state, m_ci);
+    else m_state.getBoard().movegenStage<PColor::B, Type>(m_moves, m_state, m_ci);
+}
+
+// most valuable victim first, the least valuable attacker breaks the ties; the king attacks last
+static constexpr int16_t attackerOrder_(PKind kind) noexcept {
+    return kind == PKind::pK ? QUEEN_SCORE + 1 : PieceScores[kind];
+}
+
+void MovePicker::scoreCaptures_() noexcept {
+    auto&& board = m_state.getBoard();
+    for (std::size_t i = 0; i < m_moves.size(); i++) {
+        const Move& move = m_moves[i];
+        const PKind attacker = board.kindAt(move.from);
+        const PKind victim = move.isEnpass ? PKind::pP : board.kindAt(move.to);
+        int16_t score = static_cast<int16_t>(PieceScores[victim] * 16 - attackerOrder_(attacker));
+        // the generator yields promotions as the queen promotion
+        if (attacker == PKind::pP && ((1ull << move.to) & (NRank::r1 | NRank::r8)))
+            score += (QUEEN_SCORE - PAWN_SCORE) * 16;
+        m_scores[i] = score;
+    }
+}
+
+void MovePicker::scoreQuiets_() noexcept {
+    constexpr int16_t killerScore = INT16_MAX, counterScore = INT16_MAX - 2;
+    auto&& board = m_state.getBoard();
+    for (std::size_t i = 0; i < m_moves.size(); i++) {
+        const Move& move = m_moves[i];
+        int16_t score = 0;
+        if (move == m_hints.killers[0]) score = killerScore;
+        else if (move == m_hints.killers[1]) score = killerScore - 1;
+        else if (move == m_hints.counter) score = counterScore;
+        else if (m_hints.history) score = std::min<int16_t>(m_hints.history[board.kindAt(move.from)][move.to], counterScore - 1);
+        m_scores[i] = score;
+    }
+}
+
+Move MovePicker::pickBest_() noexcept {
+    std::size_t best = m_idx;
+    for (std::size_t i = m_idx + 1; i < m_moves.size(); i++)
+        if (m_scores[i] > m_scores[best]) best = i;
+    if (best != m_idx) {
+        m_moves.swap(best, m_idx);
+        std::swap(m_scores[best], m_scores[m_idx]);
+    }
+    return m_moves[m_idx++];
+}
+
+Move MovePicker::next() noexcept {
+    switch (m_stage) {
+        case ST_HASH_MOVE: {
+            m_stage = ST_CAPTURES_GEN;
+            if (!m_hashMove.NAM()) return m_hashMove;
+            [[fallthrough]];
+        }
+        case ST_CAPTURES_GEN: {
+            generate_<MG_CAPTURES>();
+            scoreCaptures_();
+            m_stage = ST_CAPTURES;
+            [[fallthrough]];
+        }
+        case ST_CAPTURES: {
+            // selection on demand, a cutoff doesn't pay for sorting the whole list
+            while (m_idx < m_moves.size()) {
+                auto move = pickBest_();
+                if (!(move == m_hashMove)) return move;
+            }
+            m_stage = (m_type & MG_QUIETS) ? ST_QUIETS_GEN : ST_DONE;
+            if (m_stage == ST_DONE) break;
+            [[fallthrough]];
+        }
+        case ST_QUIETS_GEN: {
+            generate_<MG_QUIETS>();
+            scoreQuiets_();
+            m_stage = ST_QUIETS;
+            [[fallthrough]];
+        }
+        case ST_QUIETS: {
+            while (m_idx < m_moves.size()) {
+                auto move = pickBest_();
+                if (!(move == m_hashMove)) return move;
+            }
+            m_stage = ST_DONE;
+            [[fallthrough]];
+        }
+        case ST_DONE: break;
+    }
+    return NONE_MOVE;
+}
+
+} // namespace brd
@@ -0,0 +1,79 @@
+#ifndef INCLUDE_BOARD_MOVE_PICKER_H_
+#define INCLUDE_BOARD_MOVE_PICKER_H_
+
+#include "move.h"
+#include "board.h"
+
+namespace brd {
+class BoardState;
+
+/*
+ * @brief   Quiet move ordering of the search: the killers of the ply, the countermove of the
+ *          previous move, then the history scores of the side to move by [kind][to]
+ */
+struct QuietHints {
+    Move            killers[2]{};
+    Move            counter{};
+    const int16_t   (*history)[SQ_CNT] = nullptr;
+};
+
+/*
+ * @brief   Staged move generator: the hash move, captures (with promotions) by MVV-LVA, quiet moves
+ *          ordered by the QuietHints.
+ *          Each stage is generated lazily, so a cutoff on the early moves skips the rest of the work.
+ *          Only legal moves are yielded, checkers and pins are computed once in the constructor.
+ *          MG_CAPTURES stops after the captures (quiescence), unless the side is in check
+ */
+class MovePicker {
+public:
+    enum Stage : uint8_t {
+        ST_HASH_MOVE = 0,
+        ST_CAPTURES_GEN,
+        ST_CAPTURES,
+        ST_QUIETS_GEN,
+        ST_QUIETS,
+        ST_DONE
+    };
+
+    explicit MovePicker(const BoardState& state, PColor color, Move hashMove, MGType type = MG_ALL,
+                        const QuietHints& hints = {}) noexcept;
+    MovePicker(const MovePicker&) = delete;
+    MovePicker& operator=(const MovePicker&) = delete;
+
+    /*
+     * @brief   Next legal move or NONE_MOVE if there are no moves left
+     */
+    Move next() noexcept;
+
+    const CheckInfo& checkInfo() const noexcept;
+    Stage stage() const noexcept;
+
+private:
+    const BoardState&   m_state;
+    PColor              m_color;
+    Move                m_hashMove;
+    MGType              m_type;
+    QuietHints          m_hints;
+    CheckInfo           m_ci;
+    Stage               m_stage = ST_HASH_MOVE;
+    MoveList            m_moves{};
+    int16_t             m_scores[MoveList::capacity];
+    std::size_t         m_idx = 0;
+
+    template<MGType Type> void generate_() noexcept;
+    void scoreCaptures_() noexcept;
+    void scoreQuiets_() noexcept;
+    Move pickBest_() noexcept;
+};
+
+inline const CheckInfo& MovePicker::checkInfo() const noexcept {
+    return m_ci;
+}
+
+inline MovePicker::Stage MovePicker::stage() const noexcept {
+    return m_stage;
+}
+
+} // namespace brd
+
+#endif  // INCLUDE_BOARD_MOVE_PICKER_H_
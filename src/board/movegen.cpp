@@ -1,6 +1,7 @@
 #include "movegen.h"
 #include <array>
 #include <cstdint>
+#include <immintrin.h>
 #include "../core/defs.h"
 #include "../dbg/sg_assert.h"
 #include "board_state.h"
@@ -153,8 +154,21 @@ constexpr BB knigth_occupancy[] {
 #define DIAG_DIR_DR -7
 #define DIAG_DIR_DL -9
 
-uint64_t rook_attacks[64][4096];
-uint64_t bishop_attacks[64][512];
+// Per square lookup data, the attack sets of all the squares are packed back to back.
+// A magic index and a PEXT index both span exactly 2^bits(mask) entries, so the backends share the offsets
+struct SliderEntry_ {
+    BB mask;
+    BB magic;
+    uint32_t offset;
+    uint32_t shift;
+};
+
+constexpr size_t ROOK_ENTRIES = 102400;
+constexpr size_t BISHOP_ENTRIES = 5248;
+constexpr size_t SLIDER_ENTRIES = ROOK_ENTRIES + BISHOP_ENTRIES;
+
+static SliderBackend slider_backend = pextSupported() ? SliderBackend::Pext : SliderBackend::Magic;
+
 
 constexpr uint64_t genDirectSliding(uint8_t inputSq, int coeff, uint64_t occupied) {
     int sq = inputSq;
@@ -191,11 +205,11 @@ constexpr uint64_t genDirectSliding(uint8_t inputSq, int coeff, uint64_t occupie
         if (currSq & occupied)
             break;
 
-        if (std::abs(coeff) == 8) {
+        if (coeff == VERT_DIR_U || coeff == VERT_DIR_D) {
             if(currSq & topBottom)
                 break;
         }
-        else if (std::abs(coeff) == 1) {
+        else if (coeff == HORIZ_DIR_U || coeff == HORIZ_DIR_D) {
             if (currSq & leftRight)
                 break;
         }
@@ -220,19 +234,161 @@ constexpr uint64_t generateBishopAttacks(uint8_t sq, uint64_t occupied) {
 }
 
 
+struct SliderTables_ {
+    SliderEntry_ rook[SQ_CNT];
+    SliderEntry_ bishop[SQ_CNT];
+    uint64_t attacks[SLIDER_ENTRIES];       // magic indexed: rooks first, then bishops
+    uint64_t pextAttacks[SLIDER_ENTRIES];   // same layout, PEXT indexed
+};
+
+// rays to the board edge, positive directions first
+struct Rays_ {
+    static constexpr int rookDirs[] {VERT_DIR_U, HORIZ_DIR_U, VERT_DIR_D, HORIZ_DIR_D};
+    static constexpr int bishopDirs[] {DIAG_DIR_UR, DIAG_DIR_UL, DIAG_DIR_DR, DIAG_DIR_DL};
+    BB rook[SQ_CNT][4];
+    BB bishop[SQ_CNT][4];
+};
+
+// same as generateRookAttacks/generateBishopAttacks but cut the rays at the first blocker,
+// which keeps the compile time evaluation cheap
+constexpr BB rayAttacks_(const BB (&rays)[SQ_CNT][4], const BB (&sqRays)[4], BB occupied) {
+    BB res = 0;
+    for (int i = 0; i < 4; i++) {
+        BB blockers = sqRays[i] & occupied;
+        if (!blockers) {
+            res |= sqRays[i];
+            continue;
+        }
+        SQ blocker = i < 2 ? std::countr_zero(blockers) : 63 - std::countl_zero(blockers);
+        res |= sqRays[i] ^ rays[blocker][i];
+    }
+    return res;
+}
+
+constexpr uint32_t fillSlider_(SliderTables_& tables, SliderEntry_& entry, const BB (&rays)[SQ_CNT][4],
+                               SQ sq, BB mask, BB magic, int shift, uint32_t offset) {
+    entry = {mask, magic, offset, static_cast<uint32_t>(shift)};
+    const uint64_t entries = 1ULL << (64 - shift);
+    // carry-rippler walks the subsets of the mask in pdep order, so pext(occ, mask) == ent
+    BB occ = 0;
+    for(uint64_t ent = 0; ent < entries; ent++, occ = (occ - mask) & mask) {
+        auto attacks = rayAttacks_(rays, rays[sq], occ);
+        tables.attacks[offset + ((occ * magic) >> shift)] = attacks;
+        tables.pextAttacks[offset + ent] = attacks;
+    }
+    return offset + entries;
+}
+
+// built at compile time (.rodata): needs a raised constexpr step limit, see src/CMakeLists.txt
+static constexpr SliderTables_ sliderTables = [] {
+    Rays_ rays{};
+    for(SQ sq = 0; sq < SQ_CNT; sq++) {
+        for(int i = 0; i < 4; i++) {
+            rays.rook[sq][i] = genDirectSliding(sq, Rays_::rookDirs[i], 0x00);
+            rays.bishop[sq][i] = genDirectSliding(sq, Rays_::bishopDirs[i], 0x00);
+        }
+    }
+
+    SliderTables_ tables{};
+    uint32_t offset = 0;
+    for(SQ sq = 0; sq < SQ_CNT; sq++)
+        offset = fillSlider_(tables, tables.rook[sq], rays.rook, sq,
+                             rook_masks[sq], rook_magics[sq], rook_shifts[sq], offset);
+    for(SQ sq = 0; sq < SQ_CNT; sq++)
+        offset = fillSlider_(tables, tables.bishop[sq], rays.bishop, sq,
+                             bishop_masks[sq], bishop_magics[sq], bishop_shifts[sq], offset);
+    return tables;
+}();
+
+// cross-check against the reference generators on a few occupancies
+static_assert([] {
+    constexpr BB occupancies[] {0x00, 0xFFFF00000000FFFFULL, 0x0042240000182400ULL, 0x8100A50018005A81ULL};
+    auto lookup = [](const SliderEntry_& entry, BB occ) {
+        return sliderTables.attacks[entry.offset + (((occ & entry.mask) * entry.magic) >> entry.shift)];
+    };
+    for (BB occ : occupancies) {
+        for (SQ sq = 0; sq < SQ_CNT; sq++) {
+            if (lookup(sliderTables.rook[sq], occ) != generateRookAttacks(sq, occ)) return false;
+            if (lookup(sliderTables.bishop[sq], occ) != generateBishopAttacks(sq, occ)) return false;
+        }
+    }
+    return true;
+}());
+static_assert(sliderTables.bishop[0].offset == ROOK_ENTRIES);
+static_assert(sliderTables.bishop[SQ_CNT - 1].offset + (1u << (64 - bishop_shifts[SQ_CNT - 1])) == SLIDER_ENTRIES);
+
+struct LineTables_ {
+    BB between[SQ_CNT][SQ_CNT];
+    BB line[SQ_CNT][SQ_CNT];
+};
+
+static constexpr LineTables_ lineTables = [] {
+    constexpr int dirs[] {HORIZ_DIR_U, HORIZ_DIR_D, VERT_DIR_U, VERT_DIR_D,
+                          DIAG_DIR_UR, DIAG_DIR_UL, DIAG_DIR_DR, DIAG_DIR_DL};
+    LineTables_ tables{};
+    for (SQ sq1 = 0; sq1 < SQ_CNT; sq1++) {
+        for (int dir : dirs) {
+            const BB ray = genDirectSliding(sq1, dir, 0x00);
+            const BB fullLine = ray | genDirectSliding(sq1, -dir, 0x00) | (1ULL << sq1);
+            BB rayIt = ray;
+            while (rayIt) {
+                SQ sq2 = popLsb(rayIt);
+                tables.between[sq1][sq2] = genDirectSliding(sq1, dir, 1ULL << sq2) & ~(1ULL << sq2);
+                tables.line[sq1][sq2] = fullLine;
+            }
+        }
+    }
+    return tables;
+}();
+
+BB between(SQ sq1, SQ sq2) noexcept {
+    return lineTables.between[sq1][sq2];
+}
+
+BB line(SQ sq1, SQ sq2) noexcept {
+    return lineTables.line[sq1][sq2];
+}
+
+
+__attribute__((target("bmi2")))
+static uint64_t sliderOccupancyPext_(const SliderEntry_& entry, uint64_t occupied) noexcept {
+    return sliderTables.pextAttacks[entry.offset + _pext_u64(occupied, entry.mask)];
+}
+
+static inline uint64_t sliderOccupancy_(const SliderEntry_& entry, uint64_t occupied) noexcept {
+    if (slider_backend == SliderBackend::Pext)
+        return sliderOccupancyPext_(entry, occupied);
+
+    uint64_t occ = occupied & entry.mask;
+    occ *= entry.magic;
+    occ >>= entry.shift;
+    return sliderTables.attacks[entry.offset + occ];
+}
 
 uint64_t getRookOccupancy(SQ sq, uint64_t occupied) noexcept {
-    uint64_t occ = occupied & rook_masks[sq];
-    occ *= rook_magics[sq];
-    occ >>= rook_shifts[sq];
-    return rook_attacks[sq][occ];
+    return sliderOccupancy_(sliderTables.rook[sq], occupied);
 }
 
 uint64_t getBishopOccupancy(SQ sq, uint64_t occupied) noexcept {
-    uint64_t occ = occupied & bishop_masks[sq];
-    occ *= bishop_magics[sq];
-    occ >>= bishop_shifts[sq];
-    return bishop_attacks[sq][occ];
+    return sliderOccupancy_(sliderTables.bishop[sq], occupied);
+}
+
+bool pextSupported() noexcept {
+    __builtin_cpu_init();
+    // Zen 1/2 have microcoded PEXT which is much slower than the magics
+    return __builtin_cpu_supports("bmi2")
+        && !__builtin_cpu_is("znver1") && !__builtin_cpu_is("znver2");
+}
+
+SliderBackend sliderBackend() noexcept {
+    return slider_backend;
+}
+
+SliderBackend setSliderBackend(SliderBackend backend) noexcept {
+    if (backend != SliderBackend::Magic)
+        backend = pextSupported() ? SliderBackend::Pext : SliderBackend::Magic;
+    slider_backend = backend;
+    return slider_backend;
 }
 
 uint64_t getKingOccupancy(SQ sq) noexcept {
@@ -262,36 +418,24 @@ uint64_t getPawnAttacks(SQ sq) noexcept {
 }
 
 
-// todo: refactor
 template<PColor Color>
-uint8_t getEnpassantAttack(SQ sq, const brd::BoardState& state) noexcept {
+SQ getEnpassantSq(const brd::BoardState& state) noexcept {
     if(!state.ply()) return 0x00;
 
     const auto& lmv = state.getLastMove();
-    PKind moveKind = static_cast<PKind>(lmv.moveKind);
-    SQ from = static_cast<SQ>(lmv.from);
-    SQ to = static_cast<SQ>(lmv.to);
-    BB toMask = 1ull << to;
-    auto&& brd = state.getBoard();
-    PColor targetCol = brd.getColor(toMask);
-
-    if(moveKind != PKind::pP 
-            || std::abs((int)from - (int)to) != 16 
-            || std::abs((int)to - (int)sq) != 1
-            || to/8 != sq/8
-            || targetCol == Color) return 0x00;
+    if(static_cast<PKind>(lmv.moveKind) != PKind::pP
+            || static_cast<PColor>(lmv.moveColor) == Color
+            || std::abs((int)lmv.from - (int)lmv.to) != 16) return 0x00;
 
-    BB res = 0;
-    if constexpr (Color == PColor::W) {
-        if (!(toMask & NRank::r5)) return 0x00;
-        if (brd.empty(to+8)) res = to+8;
-    }
-    else {
-        if (!(toMask & NRank::r4)) return 0x00;
-        if (brd.empty(to-8)) res = to-8;
-    }
+    return static_cast<SQ>((lmv.from + lmv.to) / 2);
+}
 
-    return res;
+template<PColor Color>
+uint8_t getEnpassantAttack(SQ sq, const brd::BoardState& state) noexcept {
+    constexpr PColor Enemy = Color == PColor::W ? PColor::B : PColor::W;
+    SQ toEnpass = getEnpassantSq<Color>(state);
+    if (!toEnpass || !(getPawnAttacksM<Enemy>(1ull << toEnpass) & (1ull << sq))) return 0x00;
+    return toEnpass;
 }
 
 // todo: optmize bitscan
@@ -322,62 +466,13 @@ uint64_t getPawnMoves(SQ sq, const brd::BoardState& state) noexcept {
 
 
 
-[[nodiscard]] inline uint64_t lsbReset(uint64_t number) {
-    return number & (number - 1);
-}
-
-
-inline void setBit(uint64_t& number, uint64_t index) {
-    number |= (1ULL << index);
-}
-
-
-[[nodiscard]] inline bool getBit(uint64_t number, uint64_t index) {
-    return ((number >> index) & 1ULL) == 1;
-}
-uint64_t populateMask(uint64_t mask, uint64_t index) {
-    uint64_t    res = 0;
-    uint64_t i   = 0;
-    
-    while (mask) {
-        const uint64_t bit = std::countr_zero(mask);
-        
-        if (getBit(index, i)) {
-            setBit(res, bit);
-        }
-        
-        mask = lsbReset(mask);
-        i++;
-    }
-    
-    return res;
-}
-
+// the tables are constexpr, only the backend is selected here
 void init() {
-    for(SQ sq = 0; sq < SQ_CNT; sq++) {
-        int rookBitCnt = 64 - rook_shifts[sq];
-        int bishopBitCnt = 64 - bishop_shifts[sq];
-        const uint64_t rookEntries = 1ULL << rookBitCnt;
-        const uint64_t bishopEntries = 1ULL << bishopBitCnt;
-        SG_ASSERT(rookEntries <= std::size(rook_attacks[sq]), rookEntries, std::size(rook_attacks[sq]));
-        SG_ASSERT(bishopEntries <= std::size(bishop_attacks[sq]), bishopEntries, std::size(bishop_attacks[sq]));
-
-        for(uint64_t ent = 0; ent < rookEntries; ent++) {
-            uint64_t occ = populateMask(rook_masks[sq], ent);
-            auto index = (occ * rook_magics[sq]) >> rook_shifts[sq];
-            rook_attacks[sq][index] = generateRookAttacks(sq, occ);
-        }
-
-        for(uint64_t ent = 0; ent < bishopEntries; ent++) {
-            uint64_t occ = populateMask(bishop_masks[sq], ent);
-            auto index = (occ * bishop_magics[sq]) >> bishop_shifts[sq];
-            bishop_attacks[sq][index] = generateBishopAttacks(sq, occ);
-        }
-    }
+    setSliderBackend(SliderBackend::Auto);
 }
 
 template <PColor Color>
-void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noexcept {
+static brd::CastlingType availCastling_(SQ sq, const brd::BoardState& state) noexcept {
     constexpr uint64_t whiteShortCastl = 0x90;
     constexpr uint64_t whiteLongCastl = 0x11;
     constexpr uint64_t blackShortCastl= 0x9000000000000000;
@@ -420,7 +515,13 @@ void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noe
         }
     }
 
-    // state.kingUnderCheck<Color> check in the last order because of expencive attack map computation
+    return castling;
+}
+
+template <PColor Color>
+void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noexcept {
+    brd::CastlingType castling = availCastling_<Color>(sq, state);
+
     if (!castling || state.kingUnderCheck<Color>())
         return;
 
@@ -430,15 +531,34 @@ void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noe
         mvList.push(brd::mkCastling(sq, brd::CastlingType::C_LONG));
 }
 
+template <PColor Color>
+void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state, const brd::CheckInfo& ci) noexcept {
+    // squares the king passes through and lands on
+    constexpr BB shortPath = Color == PColor::W ? 0x60ULL : 0x60ULL << 56;
+    constexpr BB longPath = Color == PColor::W ? 0x0CULL : 0x0CULL << 56;
+
+    if (ci.checkers) return;
+    brd::CastlingType castling = availCastling_<Color>(sq, state);
+
+    if ((castling & brd::CastlingType::C_SHORT) && !(ci.danger & shortPath))
+        mvList.push(brd::mkCastling(sq, brd::CastlingType::C_SHORT));
+    if ((castling & brd::CastlingType::C_LONG) && !(ci.danger & longPath))
+        mvList.push(brd::mkCastling(sq, brd::CastlingType::C_LONG));
+}
+
 
 template void genCastling<PColor::W>(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noexcept;
 template void genCastling<PColor::B>(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noexcept;
+template void genCastling<PColor::W>(SQ sq, brd::MoveList& mvList, const brd::BoardState& state, const brd::CheckInfo&) noexcept;
+template void genCastling<PColor::B>(SQ sq, brd::MoveList& mvList, const brd::BoardState& state, const brd::CheckInfo&) noexcept;
 template uint64_t getPawnMoves<PColor::W>(SQ sq, const brd::BoardState&) noexcept;
 template uint64_t getPawnMoves<PColor::B>(SQ sq, const brd::BoardState&) noexcept;
 template uint64_t getPawnAttacks<PColor::W>(SQ sq) noexcept;
 template uint64_t getPawnAttacks<PColor::B>(SQ sq) noexcept;
 template uint8_t getEnpassantAttack<PColor::W>(SQ sq, const brd::BoardState& state) noexcept;
 template uint8_t getEnpassantAttack<PColor::B>(SQ sq, const brd::BoardState& state) noexcept;
+template SQ getEnpassantSq<PColor::W>(const brd::BoardState& state) noexcept;
+template SQ getEnpassantSq<PColor::B>(const brd::BoardState& state) noexcept;
 
 } // namespace movegen
 
@@ -3,10 +3,28 @@
 #include <cstdint>
 #include "../core/defs.h"
 
-namespace brd { class Board; class BoardState; struct MoveList; }
+namespace brd { class Board; class BoardState; struct MoveList; struct CheckInfo; }
 
 namespace movegen {
+/**
+ * Slider lookup backend: multiply-shift magics or BMI2 PEXT indexing
+ */
+enum class SliderBackend : uint8_t {
+    Magic,
+    Pext,
+    Auto        // Pext if the CPU has a fast one, Magic otherwise
+};
+
+/**
+ * (Re)selects the slider backend by CPUID, the attack tables are built at compile time
+ */
 void init();
+bool pextSupported() noexcept;
+SliderBackend sliderBackend() noexcept;
+/**
+ * @return  The backend actually in use (Pext falls back to Magic without BMI2)
+ */
+SliderBackend setSliderBackend(SliderBackend) noexcept;
 uint64_t getRookOccupancy(SQ sq, BB occupied) noexcept;
 uint64_t getBishopOccupancy(SQ sq, BB occupied) noexcept;
 
@@ -20,6 +38,36 @@ uint64_t getPawnAttacks(SQ sq) noexcept;
 template<PColor Color>
 uint64_t getPawnMoves(SQ sq, const brd::BoardState&) noexcept;
 
+/**
+ * Shift the whole bitboard by Delta squares (negative is down)
+ */
+template<int Delta>
+constexpr BB shiftM(BB mask) noexcept {
+    if constexpr (Delta > 0) return mask << Delta;
+    else return mask >> (-Delta);
+}
+
+/**
+ * Attack set of all the pawns in the mask (no rank restrictions)
+ */
+template<PColor Color>
+constexpr BB getPawnAttacksM(BB pawns) noexcept {
+    if constexpr (Color == PColor::W)
+        return ((pawns & ~NFile::fA) << 7) | ((pawns & ~NFile::fH) << 9);
+    else
+        return ((pawns & ~NFile::fA) >> 9) | ((pawns & ~NFile::fH) >> 7);
+}
+
+/**
+ * Squares strictly between two squares on the same rank, file or diagonal (0 otherwise)
+ */
+BB between(SQ sq1, SQ sq2) noexcept;
+
+/**
+ * The whole line (edge to edge) going through both squares (0 if they are not aligned)
+ */
+BB line(SQ sq1, SQ sq2) noexcept;
+
 template<PColor Color, PKind Kind>
 BB getPieceOccupancy(SQ sq, BB occupied) noexcept;
 
@@ -30,6 +78,12 @@ BB getPieceOccupancy(SQ sq, BB occupied) noexcept;
 template<PColor Color>
 uint8_t getEnpassantAttack(SQ sq, const brd::BoardState& state) noexcept;
 
+/**
+ * Returns the enpassant target square for the Color side (0 if the last move wasn't a double push)
+ */
+template<PColor Color>
+SQ getEnpassantSq(const brd::BoardState& state) noexcept;
+
 template <PColor Color, PKind Kind>
 BB getPieceOccupancy(SQ sq, BB occupied) noexcept {
     if constexpr (Kind == PKind::pR) {
@@ -48,11 +102,18 @@ BB getPieceOccupancy(SQ sq, BB occupied) noexcept {
     if constexpr (Kind == PKind::pN) {
         return movegen::getKnightOccupancy(sq);
     }
+    return 0x00;
 }
 
 template <PColor Color>
 void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state) noexcept;
 
+/**
+ * Legal castling: the king is not under check and doesn't pass through the attacked squares
+ */
+template <PColor Color>
+void genCastling(SQ sq, brd::MoveList& mvList, const brd::BoardState& state, const brd::CheckInfo& ci) noexcept;
+
 } // namespace movegen
 
 #endif  // INCLUDE_BOARD_MOVEGEN_H_
@@ -0,0 +1,158 @@
+#ifndef INCLUDE_BOARD_QUAD_BB_H_
+#define INCLUDE_BOARD_QUAD_BB_H_
+#include "../core/defs.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace brd {
+
+/*
+ * @brief   The four board planes in the Board member order, one 256-bit register
+ */
+struct alignas(32) QuadBB {
+    BB col;     // black pieces
+    BB pbq;
+    BB nbk;
+    BB rqk;
+};
+
+/*
+ * @brief   Piece bitboards of both sides indexed by [PColor][PKind], None stays empty
+ */
+struct PieceMasks {
+    BB masks[2][7];
+};
+
+namespace qbb {
+
+// planes a piece kind is set in, the color plane is taken from the piece color
+constexpr QuadBB kindPlanes[] {
+    {0x00, 0x00, 0x00, 0x00},           // None
+    {0x00, ~0x00ULL, 0x00, 0x00},       // pP
+    {0x00, 0x00, ~0x00ULL, ~0x00ULL},   // pK
+    {0x00, ~0x00ULL, 0x00, ~0x00ULL},   // pQ
+    {0x00, ~0x00ULL, ~0x00ULL, 0x00},   // pB
+    {0x00, 0x00, ~0x00ULL, 0x00},       // pN
+    {0x00, 0x00, 0x00, ~0x00ULL},       // pR
+};
+
+namespace scalar {
+
+/*
+ * @brief   Move the piece of the kind/color from -> to (the "to" square must be empty)
+ */
+inline QuadBB slide(QuadBB q, BB from, BB to, PKind kind, PColor color) noexcept {
+    const QuadBB& planes = kindPlanes[kind];
+    q.col = (q.col & ~from) | (color ? 0x00 : to);
+    q.pbq = (q.pbq & ~from) | (to & planes.pbq);
+    q.nbk = (q.nbk & ~from) | (to & planes.nbk);
+    q.rqk = (q.rqk & ~from) | (to & planes.rqk);
+    return q;
+}
+
+inline QuadBB clear(QuadBB q, BB mask) noexcept {
+    q.col &= ~mask;
+    q.pbq &= ~mask;
+    q.nbk &= ~mask;
+    q.rqk &= ~mask;
+    return q;
+}
+
+inline QuadBB put(QuadBB q, BB mask, PKind kind, PColor color) noexcept {
+    const QuadBB& planes = kindPlanes[kind];
+    q.col |= color ? 0x00 : mask;
+    q.pbq |= mask & planes.pbq;
+    q.nbk |= mask & planes.nbk;
+    q.rqk |= mask & planes.rqk;
+    return q;
+}
+
+inline PieceMasks pieceMasks(const QuadBB& q) noexcept {
+    const BB odd = q.pbq ^ q.nbk ^ q.rqk;
+    const BB kinds[] {0x00, q.pbq & odd, q.nbk & q.rqk, q.pbq & q.rqk, q.pbq & q.nbk, q.nbk & odd, q.rqk & odd};
+    PieceMasks pm;
+    for (int k = 0; k < 7; k++) {
+        pm.masks[PColor::W][k] = kinds[k] & ~q.col;
+        pm.masks[PColor::B][k] = kinds[k] & q.col;
+    }
+    return pm;
+}
+
+} // namespace scalar
+
+#ifdef __AVX2__
+namespace avx2 {
+
+inline __m256i load_(const QuadBB& q) noexcept {
+    return _mm256_load_si256(reinterpret_cast<const __m256i*>(&q));
+}
+
+inline QuadBB store_(__m256i v) noexcept {
+    QuadBB q;
+    _mm256_store_si256(reinterpret_cast<__m256i*>(&q), v);
+    return q;
+}
+
+// kind planes blended with the color lane
+inline __m256i planes_(PKind kind, PColor color) noexcept {
+    constexpr QuadBB colLane {~0x00ULL, 0x00, 0x00, 0x00};
+    const __m256i blackLane = _mm256_and_si256(load_(colLane), _mm256_set1_epi64x(static_cast<int64_t>(color) - 1));
+    return _mm256_or_si256(load_(kindPlanes[kind]), blackLane);
+}
+
+inline QuadBB slide(QuadBB q, BB from, BB to, PKind kind, PColor color) noexcept {
+    const __m256i cleared = _mm256_andnot_si256(_mm256_set1_epi64x(from), load_(q));
+    const __m256i added = _mm256_and_si256(_mm256_set1_epi64x(to), planes_(kind, color));
+    return store_(_mm256_or_si256(cleared, added));
+}
+
+inline QuadBB clear(QuadBB q, BB mask) noexcept {
+    return store_(_mm256_andnot_si256(_mm256_set1_epi64x(mask), load_(q)));
+}
+
+inline QuadBB put(QuadBB q, BB mask, PKind kind, PColor color) noexcept {
+    const __m256i added = _mm256_and_si256(_mm256_set1_epi64x(mask), planes_(kind, color));
+    return store_(_mm256_or_si256(load_(q), added));
+}
+
+inline PieceMasks pieceMasks(const QuadBB& q) noexcept {
+    const BB odd = q.pbq ^ q.nbk ^ q.rqk;
+    // pP, pK, pQ, pB are adjacent PKind values, pN and pR follow
+    const __m256i lo = _mm256_and_si256(_mm256_set_epi64x(q.pbq, q.pbq, q.nbk, q.pbq),
+                                        _mm256_set_epi64x(q.nbk, q.rqk, q.rqk, odd));
+    const __m128i hi = _mm_and_si128(_mm_set_epi64x(q.rqk, q.nbk), _mm_set1_epi64x(odd));
+    const __m256i black = _mm256_set1_epi64x(q.col);
+
+    PieceMasks pm;
+    pm.masks[PColor::W][PKind::None] = pm.masks[PColor::B][PKind::None] = 0x00;
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pm.masks[PColor::W][PKind::pP]), _mm256_andnot_si256(black, lo));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(&pm.masks[PColor::B][PKind::pP]), _mm256_and_si256(black, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&pm.masks[PColor::W][PKind::pN]),
+                     _mm_andnot_si128(_mm256_castsi256_si128(black), hi));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&pm.masks[PColor::B][PKind::pN]),
+                     _mm_and_si128(_mm256_castsi256_si128(black), hi));
+    return pm;
+}
+
+} // namespace avx2
+#endif
+
+// Kernels used by Board (see sparsegrid_micro_bench). The plane updates are a short dependency chain
+// on the make/unmake path where the GPR -> ymm broadcasts cost more than the 4 scalar blends
+namespace kernel {
+using scalar::slide;
+using scalar::clear;
+using scalar::put;
+#ifdef __AVX2__
+using avx2::pieceMasks;
+#else
+using scalar::pieceMasks;
+#endif
+} // namespace kernel
+
+} // namespace qbb
+} // namespace brd
+
+#endif  // INCLUDE_BOARD_QUAD_BB_H_
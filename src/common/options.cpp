@@ -4,12 +4,17 @@
 namespace common {
 
 std::string getNNGzipFile() {
+#ifdef SG_EMBEDDED_NN_WEIGHTS
+    // the NNEvaluator takes the embedded copy of it, nothing to look up
+    return std::string(NN_GZIP_PRETRAINED_WEIGHTS);
+#else
     auto execDir = std::filesystem::current_path();
     for (const auto& entry : std::filesystem::directory_iterator(execDir)) {
         if (entry.is_regular_file() && entry.path().string().ends_with(".nn"))
             return entry.path().string();
     }
     return std::string{""};
+#endif
 }
 
 } // namespace common
\ No newline at end of file
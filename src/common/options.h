@@ -7,14 +7,29 @@
 #define DEFAULT_CORES_NUMBER 1u
 #define DEFAULT_MAX_DEPTH_PLY 25u
 #define DEFAULT_TT_MEM_KB (4*1024)
+// late move reduction in plies: base + ln(depth) * ln(moveIdx) / divisor, both in hundredths
+#define DEFAULT_LMR_BASE 75u
+#define DEFAULT_LMR_DIVISOR 225u
 
 namespace common {
+/*
+ * @brief   NN inference arithmetic, picked when the weights are loaded
+ */
+enum class NNPrecision : uint8_t {
+    Double,     // reference
+    Float,      // float32 weights
+    Quantized,  // int16 weights over the int8 input, int32 accumulator
+};
+
 struct Options {
     unsigned Cores = DEFAULT_CORES_NUMBER;
     unsigned MaxDepthPly = DEFAULT_MAX_DEPTH_PLY;
     unsigned AvailMemTT = DEFAULT_TT_MEM_KB;
     PColor EngineSide = PColor::B;
-    std::string NNStateFile;
+    std::string NNStateFile;    // gzip csv or binary weights, empty selects the embedded ones (SG_EMBED_NN_WEIGHTS)
+    NNPrecision NNInference = NNPrecision::Double;
+    unsigned LmrBase = DEFAULT_LMR_BASE;
+    unsigned LmrDivisor = DEFAULT_LMR_DIVISOR;
 };
 
 std::string getNNGzipFile();
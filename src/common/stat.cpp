@@ -5,6 +5,12 @@ namespace common {
 void Stat::resetSingleSearch() noexcept {
     TTMatch = 0;
     NodesSearched = 0;
+    QNodes = 0;
+    MtdPasses = 0;
+    CutNodes = 0;
+    FirstMoveCuts = 0;
+    LmrReSearches = 0;
+    NullMoveCuts = 0;
 }
 
 
@@ -6,6 +6,12 @@ namespace common {
 struct Stat {
     uint64_t TTMatch = 0;
     uint64_t NodesSearched = 0;
+    uint64_t QNodes = 0;        // quiescence nodes
+    uint64_t MtdPasses = 0;     // null window searches of all the MTD(f) iterations
+    uint64_t CutNodes = 0;      // beta cutoffs of the full width nodes
+    uint64_t FirstMoveCuts = 0; // of them on the first move searched
+    uint64_t LmrReSearches = 0; // reduced searches which failed high
+    uint64_t NullMoveCuts = 0;  // nodes cut by the null move search
 
     void resetSingleSearch() noexcept;
 };
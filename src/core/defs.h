@@ -135,6 +135,7 @@ enum SqNum {
 
     sqn_g1 = 6,
     sqn_g2 = 14,
+    sqn_g4 = 30,
     sqn_g5 = 38,
     sqn_g8 = 62,
 
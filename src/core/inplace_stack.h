@@ -0,0 +1,64 @@
+#ifndef INCLUDE_CORE_INPLACE_STACK_H_
+#define INCLUDE_CORE_INPLACE_STACK_H_
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include "../dbg/sg_assert.h"
+
+
+/*
+ * @brief   Fixed capacity stack stored inline, never allocates.
+ *          Copies take the used part only
+ */
+template<typename T, std::size_t N>
+class InplaceStack {
+    static_assert(std::is_trivially_copyable_v<T>, "InplaceStack keeps trivially copyable records only");
+public:
+    constexpr static std::size_t capacity = N;
+
+    InplaceStack() noexcept = default;
+    InplaceStack(const InplaceStack& rhs) noexcept : m_size(rhs.m_size) {
+        std::copy_n(rhs.m_data, m_size, m_data);
+    }
+    InplaceStack& operator=(const InplaceStack& rhs) noexcept {
+        m_size = rhs.m_size;
+        std::copy_n(rhs.m_data, m_size, m_data);
+        return *this;
+    }
+
+    void push_back(const T& val) noexcept {
+        SG_ASSERT(m_size < N);
+        m_data[m_size++] = val;
+    }
+    void emplace_back(const T& val) noexcept { push_back(val); }
+    void pop_back() noexcept {
+        SG_ASSERT(m_size);
+        m_size--;
+    }
+    void clear() noexcept { m_size = 0; }
+    /*
+     * @brief   Forgets the n oldest records, the rest keep their order
+     */
+    void drop_front(std::size_t n) noexcept {
+        n = std::min(n, m_size);
+        std::copy(m_data + n, m_data + m_size, m_data);
+        m_size -= n;
+    }
+
+    T& back() noexcept { return m_data[m_size - 1]; }
+    const T& back() const noexcept { return m_data[m_size - 1]; }
+    const T& operator[](std::size_t i) const noexcept { return m_data[i]; }
+
+    std::size_t size() const noexcept { return m_size; }
+    bool empty() const noexcept { return !m_size; }
+    bool full() const noexcept { return m_size == N; }
+
+    const T* begin() const noexcept { return m_data; }
+    const T* end() const noexcept { return m_data + m_size; }
+
+private:
+    std::size_t m_size = 0;
+    T           m_data[N];
+};
+
+#endif  // INCLUDE_CORE_INPLACE_STACK_H_
@@ -1,5 +1,6 @@
 #ifndef INCLUDE_CORE_SCORES_H_
 #define INCLUDE_CORE_SCORES_H_
+#include "defs.h"
 
 #define PAWN_SCORE 1
 #define KNIGHT_SCORE 4
@@ -11,4 +12,15 @@
 
 #define INIT_MATERIAL (PAWN_SCORE*8 + KNIGHT_SCORE*2 + BISHOP_SCORE*2 + ROOK_SCORE*2 + QUEEN_SCORE)
 
+// indexed by PKind, the king isn't counted as material
+inline constexpr Score PieceScores[] = {
+    DUMMY_SCORE,    // None
+    PAWN_SCORE,
+    DUMMY_SCORE,    // pK
+    QUEEN_SCORE,
+    BISHOP_SCORE,
+    KNIGHT_SCORE,
+    ROOK_SCORE
+};
+
 #endif  // INCLUDE_CORE_SCORES_H_
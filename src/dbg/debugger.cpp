@@ -68,7 +68,7 @@ void Debugger::printNN(const brd::BoardState& state) noexcept {
     auto nn = state.getNNL();
     for (std::size_t i=0; i<nn.size(); i++) {
         if (i && i % 64 == 0) std::cout << "\n";
-        std::cout << nn[i] << " ";
+        std::cout << static_cast<int>(nn[i]) << " ";
     }
     std::cout << "\n============\n" << std::endl;
 }
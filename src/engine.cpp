@@ -26,8 +26,8 @@ void Engine<TExecutor>::initNewGame(PColor color) noexcept {
 
 template <typename TExecutor>
 void Engine<TExecutor>::setupNewBoard(PColor color) noexcept {
-    while(m_state.ply())
-        m_state.undo();
+    // not by undoing the history, a long game has dropped its first records
+    m_state.setupStartPosition();
 
     m_opts.EngineSide = color;
 }
@@ -13,7 +13,7 @@
 #include "core/CallerThreadExecutor.h"
 #include "core/ThreadPoolExecutor.h"
 
-namespace search { template<typename> class MtdSearch; }
+namespace search { template<typename, typename> class MtdSearch; }
 namespace common { struct Stat; }
 namespace eval { class Evaluator; }
 namespace uci { class Fen; }
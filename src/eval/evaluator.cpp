@@ -2,68 +2,373 @@
 #include "../common/options.h"
 #include "../board/board_state.h"
 #include <Eigen/Dense>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <memory>
-#include <gzip/decompress.hpp>
-#include <fstream>
 #include <string>
-#include <unsupported/Eigen/CXX11/Tensor>
+#include <vector>
 #include "../dbg/sg_assert.h"
+#include "nn_kernels.h"
+#include "nn_weights.h"
+#include <climits>
+#include <cmath>
 
-// todo:
-//  1. use float
-//  2. rewrite with simd
 namespace eval {
-template<int S1, int S2, int TOps, int S3, int S4, typename T>
-static Eigen::Matrix<T, S1, S2> mapInto(const Eigen::Matrix<T, S3, S4>& input) noexcept {
-    return Eigen::Matrix<T, S1, S2, TOps>(input.data());
-}
-
-constexpr static int input_channels = brd::nnLayerSize();
-constexpr static int output_channels = 128;
+constexpr static int input_channels = nnw::layout::inputs;
+constexpr static int output_channels = nnw::layout::outputs;
 constexpr static int batch_number = 40;
 constexpr static int kernel_size = input_channels / batch_number;
+constexpr static int hidden_channels = nnw::layout::hidden;
+static_assert(input_channels == brd::nnLayerSize());
 
-typedef Eigen::TensorFixedSize<double, Eigen::Sizes<output_channels, batch_number, kernel_size>> Conv1d_t;
-typedef Eigen::Matrix<double, 1, input_channels> Input_t;
-
+/*
+ * Input i is (batch i / kernel_size, kernel i % kernel_size). Only ~25% of the inputs are set,
+ * the zero ones are skipped and the weight column of a set one is contiguous (input-major layout)
+ */
 Eigen::Matrix<double, 1, output_channels> conv1d(
-    const Input_t& raw_input,
-    const Conv1d_t& weights) noexcept {
+    const brd::BoardState::nnLayer_t& input,
+    const double* weights) noexcept {
 
-    auto input = mapInto<batch_number, kernel_size, Eigen::RowMajor>(raw_input);
-    auto output = Eigen::Matrix<double, output_channels, 1>();
+    auto output = Eigen::Matrix<double, 1, output_channels>();
     output.setZero();
 
-    for (int out_ch = 0; out_ch < output_channels; out_ch++)
-        for (int bs = 0; bs < batch_number; bs++)
-            for (int k=0; k<kernel_size; k++)
-                output(out_ch, 0) += input(bs, k) * weights(out_ch, bs, k);
+    for (int i = 0; i < input_channels; i++) {
+        if (!input[i]) continue;
+        const double x = input[i];
+        const double* column = weights + i * output_channels;
+        for (int out_ch = 0; out_ch < output_channels; out_ch++)
+            output(0, out_ch) += x * column[out_ch];
+    }
 
-    return output.transpose();
+    return output;
 }
 
+typedef Eigen::Matrix<double, 1, output_channels> Accumulator_t;
+
 class SGNN {
+    /*
+     * First layer output of the last input the thread evaluated. The layer is linear,
+     * so the next leaf adds (new - old) * column for the few inputs that differ
+     */
+    struct Accumulator {
+        uint64_t                    modelId = 0;
+        uint64_t                    lastUse = 0;
+        unsigned                    updates = 0;
+        brd::BoardState::nnLayer_t  input{};
+        Accumulator_t               out;
+        alignas(32) float           outFloat[output_channels];
+        alignas(32) int32_t         outQuant[output_channels];
+    };
+    inline static std::atomic<uint64_t> s_nextModelId{1};
+    // one per model, two evaluators on a thread (the engine and a reference one) don't refresh each other.
+    // A new model takes the least recently used
+    constexpr static unsigned scThreadAccumulators = 4;
+    // float sums drift with every update, refreshed from scratch once in a while
+    constexpr static unsigned floatRefreshPeriod = 256;
+
+    // float32 copy, the layers are transposed so that every kernel reads contiguous rows
+    struct FloatWeights {
+        alignas(32) float l1[input_channels][output_channels];
+        alignas(32) float l2t[output_channels][hidden_channels];
+        alignas(32) float l2b[hidden_channels];
+        alignas(32) float outw[hidden_channels];
+        float outb;
+    };
+
+    // l1 is int16 over the int8 input, its int32 accumulator is exact (no drift).
+    // l2 is int16 in madd pairs: |activation| <= 2047 and |weight| <= 4095 keep 128 products in int32
+    struct QuantWeights {
+        alignas(32) int16_t l1[input_channels][output_channels];
+        alignas(32) int16_t l2[output_channels / 2][hidden_channels][2];
+        alignas(32) float l2b[hidden_channels];
+        alignas(32) float outw[hidden_channels];
+        float outb;
+        float l1Scale, l2Scale;
+    };
+    constexpr static float quantActivationMax = 2047.f;
+    constexpr static float quantL2WeightMax = 4095.f;
+
 public:
-    Conv1d_t conv1dl{};
-    Eigen::Matrix<double, 64, 128> lin2w{};
-    Eigen::Vector<double, 64> lin2b{};
-    Eigen::Matrix<double, 1, 64> outw{};
-    Eigen::Vector<double, 1> outb{};
+    // the double weights in the binary file layout (see nn_weights.h): l1 [input][output], l2w [hidden][output].
+    // They point into the mapped binary file, the storage parsed from the gzip csv or the embedded weights
+    const double* l1 = nullptr;
+    const double* l2w = nullptr;
+    const double* l2b = nullptr;
+    const double* outw = nullptr;
+    const double* outb = nullptr;
+    std::vector<double> storage;
+    std::unique_ptr<nnw::MappedWeights> mapped;
+    const uint64_t modelId = s_nextModelId++;
+
+    // the layers packed one after another (nnw::layout)
+    void useStorage(const double* base) noexcept {
+        l1 = base + nnw::layout::l1;
+        l2w = base + nnw::layout::l2w;
+        l2b = base + nnw::layout::l2b;
+        outw = base + nnw::layout::outw;
+        outb = base + nnw::layout::outb;
+    }
+
+    void useMapped(std::unique_ptr<nnw::MappedWeights> file) {
+        mapped = std::move(file);
+        l1 = mapped->tensor("l1.weight", {input_channels, output_channels});
+        l2w = mapped->tensor("l2.weight", {hidden_channels, output_channels});
+        l2b = mapped->tensor("l2.bias", {hidden_channels});
+        outw = mapped->tensor("lout.weight", {1, hidden_channels});
+        outb = mapped->tensor("lout.bias", {1});
+    }
+
+    void save(const std::string& path) const {
+        nnw::save(path, {
+            {"l1.weight", {input_channels, output_channels}, l1},
+            {"l2.weight", {hidden_channels, output_channels}, l2w},
+            {"l2.bias", {hidden_channels}, l2b},
+            {"lout.weight", {1, hidden_channels}, outw},
+            {"lout.bias", {1}, outb},
+        });
+    }
+
+    /*
+     * @brief   Build the weights of the selected inference path from the double ones
+     */
+    void prepare(common::NNPrecision precision) {
+        m_precision = precision;
+        if (precision == common::NNPrecision::Float) {
+            m_float = std::make_unique<FloatWeights>();
+            for (int i = 0; i < input_channels; i++)
+                for (int o = 0; o < output_channels; o++)
+                    m_float->l1[i][o] = static_cast<float>(l1[i * output_channels + o]);
+            for (int i = 0; i < output_channels; i++)
+                for (int j = 0; j < hidden_channels; j++)
+                    m_float->l2t[i][j] = static_cast<float>(l2w[j * output_channels + i]);
+            fillTail_(*m_float);
+        }
+        else if (precision == common::NNPrecision::Quantized) {
+            m_quant = std::make_unique<QuantWeights>();
+            auto absMax = [](const double* w, std::size_t n) {
+                double m = 0.;
+                for (std::size_t i = 0; i < n; i++) m = std::max(m, std::abs(w[i]));
+                return m;
+            };
+            const double l1Max = absMax(l1, input_channels * output_channels);
+            const double l2Max = absMax(l2w, hidden_channels * output_channels);
+            m_quant->l1Scale = l1Max > 0. ? static_cast<float>(INT16_MAX / l1Max) : 1.f;
+            m_quant->l2Scale = l2Max > 0. ? static_cast<float>(quantL2WeightMax / l2Max) : 1.f;
+
+            for (int i = 0; i < input_channels; i++)
+                for (int o = 0; o < output_channels; o++)
+                    m_quant->l1[i][o] = static_cast<int16_t>(std::lround(l1[i * output_channels + o] * m_quant->l1Scale));
+            for (int k = 0; k < output_channels / 2; k++)
+                for (int j = 0; j < hidden_channels; j++)
+                    for (int t = 0; t < 2; t++)
+                        m_quant->l2[k][j][t] = static_cast<int16_t>(
+                            std::lround(l2w[j * output_channels + 2*k + t] * m_quant->l2Scale));
+            fillTail_(*m_quant);
+        }
+    }
 
     [[nodiscard]] double forward(const brd::BoardState::nnLayer_t& input) const noexcept {
-        Eigen::Matrix<double, 1, input_channels> nnState(input.data());
-        auto s1 = conv1d(nnState, conv1dl);
+        switch (m_precision) {
+            case common::NNPrecision::Float: return forwardFloat_(input);
+            case common::NNPrecision::Quantized: return forwardQuant_(input);
+            default: return tail_(accumulate_(input));
+        }
+    }
+
+    /*
+     * @brief   count inputs (row-major, input_channels each) at once over blocks of rows: the sparse input
+     *          times l1, then the hidden layers as matrix products. The quantized path evaluates row by row
+     */
+    void forwardBatch(const int8_t* inputs, std::size_t count, double* out) const noexcept {
+        switch (m_precision) {
+            case common::NNPrecision::Float: {
+                const auto& w = *m_float;
+                forwardBatch_<float>(inputs, count, out,
+                    RowMajorMap_t<float>(&w.l1[0][0], input_channels, output_channels),
+                    RowMajorMap_t<float>(&w.l2t[0][0], output_channels, hidden_channels),
+                    w.l2b, w.outw, w.outb);
+                break;
+            }
+            case common::NNPrecision::Quantized: {
+                brd::BoardState::nnLayer_t layer;
+                for (std::size_t r = 0; r < count; r++) {
+                    std::memcpy(layer.data(), inputs + r * input_channels, sizeof(layer));
+                    out[r] = forwardQuant_(layer);
+                }
+                break;
+            }
+            default:
+                forwardBatch_<double>(inputs, count, out,
+                    RowMajorMap_t<double>(l1, input_channels, output_channels),
+                    RowMajorMap_t<double>(l2w, hidden_channels, output_channels).transpose(),
+                    l2b, outw, outb[0]);
+        }
+    }
+
+private:
+    common::NNPrecision             m_precision = common::NNPrecision::Double;
+    std::unique_ptr<FloatWeights>   m_float;
+    std::unique_ptr<QuantWeights>   m_quant;
+
+    void fillTail_(auto& weights) const noexcept {
+        for (int j = 0; j < hidden_channels; j++) {
+            weights.l2b[j] = static_cast<float>(l2b[j]);
+            weights.outw[j] = static_cast<float>(outw[j]);
+        }
+        weights.outb = static_cast<float>(outb[0]);
+    }
+
+    /*
+     * @brief   Bring the thread accumulator of the model to the input: refresh() on a new model
+     *          (or a due refresh), otherwise update(i, delta) for every input that changed since its last call
+     */
+    template<typename TRefresh, typename TUpdate>
+    Accumulator& accumulate_(const brd::BoardState::nnLayer_t& input, unsigned refreshPeriod,
+                             TRefresh&& refresh, TUpdate&& update) const noexcept {
+        thread_local Accumulator accs[scThreadAccumulators];
+        thread_local uint64_t uses = 0;
+        auto* found = std::find_if(std::begin(accs), std::end(accs),
+                                   [this](const Accumulator& a) { return a.modelId == modelId; });
+        if (found == std::end(accs))
+            found = std::min_element(std::begin(accs), std::end(accs),
+                                     [](const Accumulator& a, const Accumulator& b) { return a.lastUse < b.lastUse; });
+        Accumulator& acc = *found;
+        acc.lastUse = ++uses;
+        if (acc.modelId != modelId || ++acc.updates >= refreshPeriod) {
+            acc.modelId = modelId;
+            acc.updates = 0;
+            acc.input = input;
+            refresh(acc);
+            return acc;
+        }
+
+        // compare 8 inputs at once, a leaf usually differs from the previous one in a few words
+        constexpr std::size_t words = input_channels / sizeof(uint64_t);
+        for (std::size_t w = 0; w < words; w++) {
+            uint64_t prev, next;
+            std::memcpy(&prev, acc.input.data() + w * sizeof(uint64_t), sizeof(uint64_t));
+            std::memcpy(&next, input.data() + w * sizeof(uint64_t), sizeof(uint64_t));
+            if (prev == next) continue;
+
+            for (std::size_t i = w * sizeof(uint64_t); i < (w + 1) * sizeof(uint64_t); i++) {
+                const int delta = input[i] - acc.input[i];
+                if (delta) update(acc, static_cast<int>(i), delta);
+            }
+        }
+        acc.input = input;
+        return acc;
+    }
+
+    const Accumulator_t& accumulate_(const brd::BoardState::nnLayer_t& input) const noexcept {
+        return accumulate_(input, UINT_MAX,
+            [this](Accumulator& acc) { acc.out = conv1d(acc.input, l1); },
+            [this](Accumulator& acc, int i, int delta) {
+                const double* column = l1 + i * output_channels;
+                for (int out_ch = 0; out_ch < output_channels; out_ch++)
+                    acc.out(0, out_ch) += delta * column[out_ch];
+            }).out;
+    }
+
+    [[nodiscard]] double forwardFloat_(const brd::BoardState::nnLayer_t& input) const noexcept {
+        const auto& weights = *m_float;
+        const auto& acc = accumulate_(input, floatRefreshPeriod,
+            [&weights](Accumulator& acc) {
+                std::fill_n(acc.outFloat, output_channels, 0.f);
+                for (int i = 0; i < input_channels; i++)
+                    if (acc.input[i]) nnk::kernel::addColumn<output_channels>(acc.outFloat, weights.l1[i], acc.input[i]);
+            },
+            [&weights](Accumulator& acc, int i, int delta) {
+                nnk::kernel::addColumn<output_channels>(acc.outFloat, weights.l1[i], static_cast<float>(delta));
+            });
+
+        alignas(32) float h1[output_channels];
+        alignas(32) float h2[hidden_channels];
+        std::copy_n(acc.outFloat, output_channels, h1);
+        nnk::kernel::leakyRelu<output_channels>(h1, 0.1f);
+        nnk::kernel::linear<output_channels, hidden_channels>(h1, weights.l2t, weights.l2b, h2);
+        nnk::kernel::leakyRelu<hidden_channels>(h2, 0.3f);
+        return Sigmoid(nnk::kernel::dot<hidden_channels>(h2, weights.outw) + weights.outb);
+    }
+
+    [[nodiscard]] double forwardQuant_(const brd::BoardState::nnLayer_t& input) const noexcept {
+        const auto& weights = *m_quant;
+        const auto& acc = accumulate_(input, UINT_MAX,
+            [&weights](Accumulator& acc) {
+                std::fill_n(acc.outQuant, output_channels, 0);
+                for (int i = 0; i < input_channels; i++)
+                    if (acc.input[i]) nnk::kernel::addColumn<output_channels>(acc.outQuant, weights.l1[i], acc.input[i]);
+            },
+            [&weights](Accumulator& acc, int i, int delta) {
+                nnk::kernel::addColumn<output_channels>(acc.outQuant, weights.l1[i], delta);
+            });
+
+        alignas(32) float h1[output_channels];
+        const float l1Inv = 1.f / weights.l1Scale;
+        for (int i = 0; i < output_channels; i++) h1[i] = static_cast<float>(acc.outQuant[i]) * l1Inv;
+        nnk::kernel::leakyRelu<output_channels>(h1, 0.1f);
+
+        // activations are quantized per evaluation to the full int16 budget of the madd layer
+        float h1Max = 0.f;
+        for (int i = 0; i < output_channels; i++) h1Max = std::max(h1Max, std::abs(h1[i]));
+        const float actScale = h1Max > 0.f ? quantActivationMax / h1Max : 1.f;
+        alignas(32) int16_t h1q[output_channels];
+        for (int i = 0; i < output_channels; i++) h1q[i] = static_cast<int16_t>(std::lrint(h1[i] * actScale));
+
+        alignas(32) int32_t h2q[hidden_channels];
+        alignas(32) float h2[hidden_channels];
+        nnk::kernel::linear<output_channels, hidden_channels>(h1q, weights.l2, h2q);
+        const float l2Inv = 1.f / (actScale * weights.l2Scale);
+        for (int j = 0; j < hidden_channels; j++) h2[j] = static_cast<float>(h2q[j]) * l2Inv + weights.l2b[j];
+        nnk::kernel::leakyRelu<hidden_channels>(h2, 0.3f);
+        return Sigmoid(nnk::kernel::dot<hidden_channels>(h2, weights.outw) + weights.outb);
+    }
+
+    template<typename T>
+    using RowMajor_t = Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    template<typename T>
+    using RowMajorMap_t = Eigen::Map<const RowMajor_t<T>>;
+    // rows of a batch block, its activations stay in L2
+    constexpr static std::size_t batchBlock = 256;
+
+    template<typename T, typename TW1, typename TW2t>
+    void forwardBatch_(const int8_t* inputs, std::size_t count, double* out, const TW1& w1, const TW2t& w2t,
+                       const T* b2, const T* ow, T ob) const noexcept {
+        Eigen::Map<const Eigen::Vector<T, hidden_channels>> bias2(b2), outWeights(ow);
+        RowMajor_t<T> h1, h2;
+        Eigen::Vector<T, Eigen::Dynamic> z;
+        for (std::size_t first = 0; first < count; first += batchBlock) {
+            const auto rows = static_cast<Eigen::Index>(std::min(batchBlock, count - first));
+            h1.setZero(rows, output_channels);
+            for (Eigen::Index r = 0; r < rows; r++) {
+                const int8_t* row = inputs + (first + static_cast<std::size_t>(r)) * input_channels;
+                for (int i = 0; i < input_channels; i++)
+                    if (row[i]) h1.row(r) += T(row[i]) * w1.row(i);
+            }
+            h1 = h1.unaryExpr([](T v) { return std::max(v, T(0.1) * v); });
+            h2.noalias() = h1 * w2t;
+            h2.rowwise() += bias2.transpose();
+            h2 = h2.unaryExpr([](T v) { return std::max(v, T(0.3) * v); });
+            z.noalias() = h2 * outWeights;
+            for (Eigen::Index r = 0; r < rows; r++)
+                out[first + static_cast<std::size_t>(r)] = Sigmoid(static_cast<double>(z(r) + ob));
+        }
+    }
+
+    [[nodiscard]] double tail_(const Accumulator_t& s1) const noexcept {
+        Eigen::Map<const Eigen::Matrix<double, hidden_channels, output_channels, Eigen::RowMajor>> lin2w(l2w);
+        Eigen::Map<const Eigen::Vector<double, hidden_channels>> lin2b(l2b);
+        Eigen::Map<const Eigen::Matrix<double, 1, hidden_channels>> linOutw(outw);
+
         auto s2 = s1.unaryExpr(&LeakyReLU01);
         auto s3 = s2 * lin2w.transpose();
         auto s4 = s3 + lin2b.transpose();
         auto s5 = s4.unaryExpr(&LeakyReLU03);
-        auto s6 = s5 * outw.transpose();
-        auto s7 = s6 + outb.transpose();
-        auto s8 = s7.unaryExpr(&Sigmoid);
-
-        return s8(0,0);
+        auto s6 = s5 * linOutw.transpose();
+        return Sigmoid(s6(0, 0) + outb[0]);
     }
 
+public:
     template<double Slope> static double LeakyReLU(double x) noexcept {
         return (x >= 0.0) ? x : Slope * x;
     }
@@ -74,67 +379,25 @@ public:
     static double LeakyReLU03(double x) noexcept { return LeakyReLU<0.3>(x); }
 };
 
-void read_csv(std::istream& str, auto&& callback, int dims = 2) {
-    std::string line, cell;
-    std::getline(str, line);
-    std::stringstream lineStream(line);
-
-    std::getline(lineStream, cell, ','); // skip name of the parameter
-    for (int i=0; i<dims; i++) {
-        std::getline(lineStream, cell, ',');
-        auto _ = std::stoul(cell);
-    }
-
-    callback(lineStream);
-
-    SG_ASSERT(!std::getline(lineStream, cell, ',') || cell.empty());
-}
-
-template<typename TT, typename TSizes>
-void read_into(std::stringstream& lineStream, Eigen::TensorFixedSize<TT, TSizes>& layer) noexcept {
-    std::string cell;
-    for (int i=0; i<layer.dimension(0); i++)
-        for (int j=0; j<layer.dimension(1); j++)
-            for (int k=0; k<layer.dimension(2); k++) {
-                std::getline(lineStream, cell, ',');
-                layer(i, j, k) = std::stod(cell);
-            }
-}
-
-template<typename TT, int TS1, int TS2>
-void read_into(std::stringstream& lineStream, Eigen::Matrix<TT, TS1, TS2>& layer) noexcept {
-    std::string cell;
-    for(int i=0; i<layer.rows(); i++) {
-        for(int j=0; j<layer.cols(); j++) {
-            std::getline(lineStream, cell, ',');
-            layer(i, j) = std::stod(cell);
-        }
-    }
-}
-
 NNEvaluator::~NNEvaluator() = default;
 NNEvaluator::NNEvaluator(const common::Options& opts) : m_opts(opts) {
     m_model = std::make_unique<SGNN>();
-    std::ifstream istr(opts.NNStateFile);
-    if (!istr.good()) {
-        istr.close();
-        throw std::runtime_error(".nn file not found");
+#ifdef SG_EMBEDDED_NN_WEIGHTS
+    if (opts.NNStateFile.empty() || opts.NNStateFile == NN_GZIP_PRETRAINED_WEIGHTS)
+        m_model->useStorage(nnw::embeddedWeights);
+    else
+#endif
+    if (nnw::isBinaryWeights(opts.NNStateFile))
+        m_model->useMapped(std::make_unique<nnw::MappedWeights>(opts.NNStateFile));
+    else {
+        m_model->storage = nnw::readGzipCsv(opts.NNStateFile);
+        m_model->useStorage(m_model->storage.data());
     }
+    m_model->prepare(opts.NNInference);
+}
 
-    std::string content((std::istreambuf_iterator<char>(istr)), std::istreambuf_iterator<char>());
-    std::string decompressed = gzip::decompress(content.data(), content.size());
-    std::stringstream ptr{decompressed};
-
-    read_csv(ptr,
-             [&layer = m_model->conv1dl](std::stringstream& ls) { read_into(ls, layer); },
-             3);
-
-    read_csv(ptr, [&layer = m_model->lin2w](std::stringstream& ls) { read_into(ls, layer); });
-    read_csv(ptr, [&layer = m_model->lin2b](std::stringstream& ls) { read_into(ls, layer); });
-    read_csv(ptr, [&layer = m_model->outw](std::stringstream& ls) { read_into(ls, layer); });
-    read_csv(ptr, [&layer = m_model->outb](std::stringstream& ls) { read_into(ls, layer); });
-
-    istr.close();
+void NNEvaluator::saveBinary(const std::string& path) const {
+    m_model->save(path);
 }
 
 Score NNEvaluator::evaluate(const brd::BoardState& state) noexcept {
@@ -142,10 +405,20 @@ Score NNEvaluator::evaluate(const brd::BoardState& state) noexcept {
     return static_cast<Score>(SCORE_SCALE_FACTOR * (2.0 * res - 1.0)/2.0);
 }
 
-inline double NNEvaluator::evaluateRaw(const brd::BoardState& state) noexcept {
+double NNEvaluator::evaluateRaw(const brd::BoardState& state) noexcept {
     return m_model->forward(state.getNNL());
 }
 
+void NNEvaluator::evaluateRawBatch(const int8_t* inputs, std::size_t count, double* out) noexcept {
+    m_model->forwardBatch(inputs, count, out);
+}
+
+double NNEvaluator::evaluateRaw(const int8_t* input) noexcept {
+    brd::BoardState::nnLayer_t layer;
+    std::memcpy(layer.data(), input, sizeof(layer));
+    return m_model->forward(layer);
+}
+
 Score MaterialEvaluator::evaluate(const brd::BoardState& state) noexcept {
     Score scoreF = state.nonPawnMaterial(m_opts.EngineSide);
     Score scoreS = state.nonPawnMaterial(invert(m_opts.EngineSide));
@@ -1,12 +1,16 @@
 #ifndef INCLUDE_EVAL_EVALUATOR_H_
 #define INCLUDE_EVAL_EVALUATOR_H_
 #include "../core/defs.h"
+#include <cstddef>
 #include <memory>
+#include <string>
 
 #define INF 16639
 #define CHECKMATE_EVAL 8447
 #define MIN_CHECKMATE_EVAL 8410
 #define SCORE_SCALE_FACTOR 8100
+// the NN score is (win probability - 0.5) * SCORE_SCALE_FACTOR, a pawn is roughly +0.12
+#define NN_PAWN_SCORE (SCORE_SCALE_FACTOR / 8)
 
 
 namespace brd { class BoardState; class Board; }
@@ -17,6 +21,11 @@ namespace eval {
 class Evaluator {
 public:
     virtual Score evaluate(const brd::BoardState&) noexcept = 0;
+
+    /*
+     * @brief   Score of a pawn, the unit of the material margins in search (PieceScores are in pawns)
+     */
+    virtual Score pawnScore() const noexcept { return 1; }
 };
 
 class MaterialEvaluator : public Evaluator {
@@ -34,9 +43,30 @@ private:
 class SGNN;
 class NNEvaluator : public Evaluator {
 public:
+    /*
+     * @brief   Load the weights of opts.NNStateFile: the binary format (mapped in place) or the gzip csv
+     */
     explicit NNEvaluator(const common::Options& opts);
     Score evaluate(const brd::BoardState&) noexcept override;
+    Score pawnScore() const noexcept override { return NN_PAWN_SCORE; }
     double evaluateRaw(const brd::BoardState&) noexcept;
+
+    /*
+     * @brief   Raw evaluation of an NN input plane: brd::nnLayerSize() values as in BoardState::getNNL()
+     */
+    double evaluateRaw(const int8_t* input) noexcept;
+
+    /*
+     * @brief   Raw evaluations of count input planes stored one after another, out[i] for the i-th plane.
+     *          The layers run as matrix products over blocks of positions (no incremental accumulator),
+     *          for unrelated positions such as training data
+     */
+    void evaluateRawBatch(const int8_t* inputs, std::size_t count, double* out) noexcept;
+
+    /*
+     * @brief   Write the loaded weights in the binary format (eval/nn_weights.h)
+     */
+    void saveBinary(const std::string& path) const;
     ~NNEvaluator();
 
 private:
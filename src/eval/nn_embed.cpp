@@ -0,0 +1,57 @@
+#include "nn_weights.h"
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <vector>
+
+/*
+ * Build time generator of the embedded weights (SG_EMBED_NN_WEIGHTS):
+ *  nn_embed <weights: gzip csv or binary> <output .cpp>
+ * The values are written as hex floats, so the embedded weights are bit exact
+ */
+static std::vector<double> loadPacked(const std::string& path) {
+    using namespace eval::nnw;
+    if (!isBinaryWeights(path))
+        return readGzipCsv(path);
+
+    MappedWeights mapped(path);
+    std::vector<double> storage(layout::size);
+    auto copy = [&](const char* name, std::initializer_list<uint32_t> shape, std::size_t offset) {
+        std::size_t count = 1;
+        for (auto dim : shape) count *= dim;
+        const double* src = mapped.tensor(name, shape);
+        std::copy(src, src + count, storage.begin() + static_cast<std::ptrdiff_t>(offset));
+    };
+    copy("l1.weight", {layout::inputs, layout::outputs}, layout::l1);
+    copy("l2.weight", {layout::hidden, layout::outputs}, layout::l2w);
+    copy("l2.bias", {layout::hidden}, layout::l2b);
+    copy("lout.weight", {1, layout::hidden}, layout::outw);
+    copy("lout.bias", {1}, layout::outb);
+    return storage;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "usage: nn_embed <weights> <output.cpp>" << std::endl;
+        return 1;
+    }
+
+    try {
+        auto storage = loadPacked(argv[1]);
+        std::FILE* out = std::fopen(argv[2], "w");
+        if (!out) throw std::runtime_error(std::string("can't write ") + argv[2]);
+
+        std::fprintf(out, "// Generated by nn_embed from %s, do not edit\n", argv[1]);
+        std::fprintf(out, "namespace eval::nnw {\n");
+        std::fprintf(out, "extern const double embeddedWeights[%zu];\n", storage.size());
+        std::fprintf(out, "alignas(64) const double embeddedWeights[%zu] = {\n", storage.size());
+        for (std::size_t i = 0; i < storage.size(); i++)
+            std::fprintf(out, "%a,%s", storage[i], (i % 8 == 7) ? "\n" : " ");
+        std::fprintf(out, "\n};\n} // namespace eval::nnw\n");
+        std::fclose(out);
+    } catch (const std::exception& e) {
+        std::cerr << "nn_embed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+#ifndef INCLUDE_EVAL_NN_KERNELS_H_
+#define INCLUDE_EVAL_NN_KERNELS_H_
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+namespace eval::nnk {
+
+namespace scalar {
+
+/*
+ * @brief   acc += delta * column, the first layer update for one changed input
+ */
+template<int N>
+inline void addColumn(float* acc, const float* column, float delta) noexcept {
+    for (int i = 0; i < N; i++) acc[i] += delta * column[i];
+}
+
+template<int N>
+inline void addColumn(int32_t* acc, const int16_t* column, int32_t delta) noexcept {
+    for (int i = 0; i < N; i++) acc[i] += delta * column[i];
+}
+
+/*
+ * @brief   0 < slope < 1, so leaky relu is max(x, slope * x)
+ */
+template<int N>
+inline void leakyRelu(float* x, float slope) noexcept {
+    for (int i = 0; i < N; i++) x[i] = std::max(x[i], slope * x[i]);
+}
+
+/*
+ * @brief   out = bias + in * W, W stored transposed (row per input) so every input is one axpy
+ */
+template<int NIn, int NOut>
+inline void linear(const float* in, const float (*wt)[NOut], const float* bias, float* out) noexcept {
+    std::memcpy(out, bias, NOut * sizeof(float));
+    for (int i = 0; i < NIn; i++)
+        for (int j = 0; j < NOut; j++) out[j] += in[i] * wt[i][j];
+}
+
+/*
+ * @brief   out = in * W in int32, W stored as [input pair][output][2] (the madd layout)
+ */
+template<int NIn, int NOut>
+inline void linear(const int16_t* in, const int16_t (*wp)[NOut][2], int32_t* out) noexcept {
+    std::fill_n(out, NOut, 0);
+    for (int k = 0; k < NIn / 2; k++)
+        for (int j = 0; j < NOut; j++)
+            out[j] += in[2*k] * wp[k][j][0] + in[2*k+1] * wp[k][j][1];
+}
+
+template<int N>
+inline float dot(const float* a, const float* b) noexcept {
+    float r = 0.f;
+    for (int i = 0; i < N; i++) r += a[i] * b[i];
+    return r;
+}
+
+} // namespace scalar
+
+#ifdef __AVX2__
+namespace avx2 {
+
+template<int N>
+inline void addColumn(float* acc, const float* column, float delta) noexcept {
+    static_assert(N % 8 == 0);
+    const __m256 d = _mm256_set1_ps(delta);
+    for (int i = 0; i < N; i += 8) {
+        const __m256 c = _mm256_load_ps(column + i);
+        _mm256_store_ps(acc + i, _mm256_add_ps(_mm256_load_ps(acc + i), _mm256_mul_ps(d, c)));
+    }
+}
+
+template<int N>
+inline void addColumn(int32_t* acc, const int16_t* column, int32_t delta) noexcept {
+    static_assert(N % 8 == 0);
+    const __m256i d = _mm256_set1_epi32(delta);
+    for (int i = 0; i < N; i += 8) {
+        const __m256i c = _mm256_cvtepi16_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(column + i)));
+        const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(acc + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi32(a, _mm256_mullo_epi32(d, c)));
+    }
+}
+
+template<int N>
+inline void leakyRelu(float* x, float slope) noexcept {
+    static_assert(N % 8 == 0);
+    const __m256 s = _mm256_set1_ps(slope);
+    for (int i = 0; i < N; i += 8) {
+        const __m256 v = _mm256_load_ps(x + i);
+        _mm256_store_ps(x + i, _mm256_max_ps(v, _mm256_mul_ps(s, v)));
+    }
+}
+
+// all the NOut outputs stay in registers, the inputs are broadcast one by one
+template<int NIn, int NOut>
+inline void linear(const float* in, const float (*wt)[NOut], const float* bias, float* out) noexcept {
+    static_assert(NOut == 64, "8 ymm accumulators");
+    __m256 acc[8];
+    for (int j = 0; j < 8; j++) acc[j] = _mm256_load_ps(bias + 8*j);
+    for (int i = 0; i < NIn; i++) {
+        const __m256 x = _mm256_set1_ps(in[i]);
+        for (int j = 0; j < 8; j++)
+            acc[j] = _mm256_add_ps(acc[j], _mm256_mul_ps(x, _mm256_load_ps(wt[i] + 8*j)));
+    }
+    for (int j = 0; j < 8; j++) _mm256_store_ps(out + 8*j, acc[j]);
+}
+
+// an input pair is broadcast as one int32, madd multiplies it with the pair of every output
+template<int NIn, int NOut>
+inline void linear(const int16_t* in, const int16_t (*wp)[NOut][2], int32_t* out) noexcept {
+    static_assert(NOut == 64, "8 ymm accumulators");
+    __m256i acc[8];
+    for (int j = 0; j < 8; j++) acc[j] = _mm256_setzero_si256();
+    for (int k = 0; k < NIn / 2; k++) {
+        int32_t pair;
+        std::memcpy(&pair, in + 2*k, sizeof(pair));
+        const __m256i x = _mm256_set1_epi32(pair);
+        for (int j = 0; j < 8; j++) {
+            const __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i*>(wp[k][8*j]));
+            acc[j] = _mm256_add_epi32(acc[j], _mm256_madd_epi16(x, w));
+        }
+    }
+    for (int j = 0; j < 8; j++) _mm256_store_si256(reinterpret_cast<__m256i*>(out + 8*j), acc[j]);
+}
+
+template<int N>
+inline float dot(const float* a, const float* b) noexcept {
+    static_assert(N % 8 == 0);
+    __m256 acc = _mm256_setzero_ps();
+    for (int i = 0; i < N; i += 8)
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_load_ps(a + i), _mm256_load_ps(b + i)));
+    const __m128 s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    const __m128 h = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    return _mm_cvtss_f32(_mm_add_ss(h, _mm_shuffle_ps(h, h, 1)));
+}
+
+} // namespace avx2
+#endif
+
+// Kernels used by the SGNN float and quantized paths
+namespace kernel {
+#ifdef __AVX2__
+using avx2::addColumn;
+using avx2::leakyRelu;
+using avx2::linear;
+using avx2::dot;
+#else
+using scalar::addColumn;
+using scalar::leakyRelu;
+using scalar::linear;
+using scalar::dot;
+#endif
+} // namespace kernel
+
+} // namespace eval::nnk
+
+#endif  // INCLUDE_EVAL_NN_KERNELS_H_
@@ -0,0 +1,180 @@
+#include "nn_weights.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <gzip/decompress.hpp>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace eval::nnw {
+
+uint64_t checksum(const void* data, std::size_t size) noexcept {
+    auto bytes = static_cast<const uint8_t*>(data);
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < size; i++) {
+        h ^= bytes[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+bool isBinaryWeights(const std::string& path) noexcept {
+    std::ifstream istr(path, std::ios::binary);
+    char buf[sizeof(magic)]{};
+    istr.read(buf, sizeof(buf));
+    return istr.good() && std::memcmp(buf, magic, sizeof(magic)) == 0;
+}
+
+static std::size_t alignUp(std::size_t v) noexcept {
+    return (v + alignment - 1) / alignment * alignment;
+}
+
+MappedWeights::MappedWeights(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("weights file not found: " + path);
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(FileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("weights file is truncated: " + path);
+    }
+    m_size = static_cast<std::size_t>(st.st_size);
+    void* addr = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) throw std::runtime_error("weights file can't be mapped: " + path);
+    m_data = static_cast<const uint8_t*>(addr);
+
+    const auto& h = header_();
+    const char* error = nullptr;
+    if (std::memcmp(h.magic, magic, sizeof(magic)) != 0) error = "bad magic";
+    else if (h.version != version) error = "unsupported version";
+    else if (h.dtype != static_cast<uint32_t>(DType::F64)) error = "unsupported dtype";
+    else if (sizeof(FileHeader) + h.tensorCount * sizeof(TensorEntry) > m_size
+             || h.payloadOffset > m_size || h.payloadSize > m_size - h.payloadOffset) error = "truncated";
+    else if (checksum(m_data + h.payloadOffset, h.payloadSize) != h.checksum) error = "checksum mismatch";
+
+    if (error) {
+        ::munmap(addr, m_size);
+        throw std::runtime_error(std::string("weights file ") + path + ": " + error);
+    }
+}
+
+MappedWeights::~MappedWeights() {
+    ::munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+const FileHeader& MappedWeights::header_() const noexcept {
+    return *reinterpret_cast<const FileHeader*>(m_data);
+}
+
+const double* MappedWeights::tensor(std::string_view name, std::initializer_list<uint32_t> shape) const {
+    const auto& h = header_();
+    auto entries = reinterpret_cast<const TensorEntry*>(m_data + sizeof(FileHeader));
+    for (uint32_t t = 0; t < h.tensorCount; t++) {
+        const auto& e = entries[t];
+        if (name != std::string_view(e.name, strnlen(e.name, sizeof(e.name)))) continue;
+
+        uint64_t count = 1;
+        bool sameShape = e.ndim == shape.size();
+        for (uint32_t d = 0; sameShape && d < e.ndim; d++) {
+            sameShape = e.shape[d] == shape.begin()[d];
+            count *= e.shape[d];
+        }
+        if (!sameShape || count != e.count)
+            throw std::runtime_error("weights tensor has an unexpected shape: " + std::string(name));
+        if (e.offset % alignof(double) || e.offset < h.payloadOffset
+            || e.offset + count * sizeof(double) > h.payloadOffset + h.payloadSize)
+            throw std::runtime_error("weights tensor is out of the payload: " + std::string(name));
+        return reinterpret_cast<const double*>(m_data + e.offset);
+    }
+    throw std::runtime_error("weights tensor is missing: " + std::string(name));
+}
+
+void save(const std::string& path, const std::vector<TensorView>& tensors) {
+    FileHeader header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.dtype = static_cast<uint32_t>(DType::F64);
+    header.tensorCount = static_cast<uint32_t>(tensors.size());
+    header.payloadOffset = alignUp(sizeof(FileHeader) + tensors.size() * sizeof(TensorEntry));
+
+    std::vector<TensorEntry> entries(tensors.size());
+    std::size_t offset = header.payloadOffset;
+    for (std::size_t t = 0; t < tensors.size(); t++) {
+        auto& e = entries[t];
+        const auto& tv = tensors[t];
+        std::memcpy(e.name, tv.name.data(), std::min(tv.name.size(), sizeof(e.name) - 1));
+        e.ndim = static_cast<uint32_t>(tv.shape.size());
+        e.count = 1;
+        for (std::size_t d = 0; d < tv.shape.size(); d++) {
+            e.shape[d] = tv.shape[d];
+            e.count *= tv.shape[d];
+        }
+        e.offset = offset;
+        offset = alignUp(offset + e.count * sizeof(double));
+    }
+
+    std::vector<uint8_t> payload(offset - header.payloadOffset, 0);
+    for (std::size_t t = 0; t < tensors.size(); t++)
+        std::memcpy(payload.data() + (entries[t].offset - header.payloadOffset),
+                    tensors[t].data, entries[t].count * sizeof(double));
+    header.payloadSize = payload.size();
+    header.checksum = checksum(payload.data(), payload.size());
+
+    std::ofstream ostr(path, std::ios::binary | std::ios::trunc);
+    if (!ostr.good()) throw std::runtime_error("weights file can't be written: " + path);
+    const std::vector<uint8_t> gap(header.payloadOffset - sizeof(FileHeader) - entries.size() * sizeof(TensorEntry), 0);
+    ostr.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ostr.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(TensorEntry)));
+    ostr.write(reinterpret_cast<const char*>(gap.data()), static_cast<std::streamsize>(gap.size()));
+    ostr.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+}
+
+// a csv line is: name, shape (dims values), values in the torch order. index(i) places the i-th value
+static void readCsvLine(std::istream& str, const char* name, int dims, double* dst, std::size_t count, auto&& index) {
+    std::string line, cell;
+    std::getline(str, line);
+    std::stringstream lineStream(line);
+
+    std::getline(lineStream, cell, ',');
+    if (cell != name) throw std::runtime_error(std::string(".nn file: expected ") + name + ", got " + cell);
+    std::size_t total = 1;
+    for (int i=0; i<dims; i++) {
+        std::getline(lineStream, cell, ',');
+        total *= std::stoul(cell);
+    }
+    if (total != count) throw std::runtime_error(std::string(".nn file: unexpected shape of ") + name);
+
+    for (std::size_t i=0; i<count; i++) {
+        std::getline(lineStream, cell, ',');
+        dst[index(i)] = std::stod(cell);
+    }
+}
+
+std::vector<double> readGzipCsv(const std::string& path) {
+    std::ifstream istr(path);
+    if (!istr.good()) throw std::runtime_error(".nn file not found");
+
+    std::string content((std::istreambuf_iterator<char>(istr)), std::istreambuf_iterator<char>());
+    std::string decompressed = gzip::decompress(content.data(), content.size());
+    std::stringstream ptr{decompressed};
+
+    std::vector<double> storage(layout::size, 0.0);
+    double* st = storage.data();
+    auto same = [](std::size_t i) { return i; };
+    // conv1d weight (output, batch, kernel) goes input-major
+    readCsvLine(ptr, "l1.weight", 3, st + layout::l1, layout::inputs * layout::outputs, [](std::size_t i) {
+        return (i % layout::inputs) * layout::outputs + i / layout::inputs;
+    });
+    readCsvLine(ptr, "l2.weight", 2, st + layout::l2w, layout::hidden * layout::outputs, same);
+    readCsvLine(ptr, "l2.bias", 2, st + layout::l2b, layout::hidden, same);
+    readCsvLine(ptr, "lout.weight", 2, st + layout::outw, layout::hidden, same);
+    readCsvLine(ptr, "lout.bias", 2, st + layout::outb, 1, same);
+    return storage;
+}
+
+} // namespace eval::nnw
@@ -0,0 +1,125 @@
+#ifndef INCLUDE_EVAL_NN_WEIGHTS_H_
+#define INCLUDE_EVAL_NN_WEIGHTS_H_
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/*
+ * Binary SGNN weight file, written by sgtrain/converters.py (sg_export_binary_weights).
+ * Little endian, mapped read-only and used in place, so the pages are shared between processes.
+ *
+ *  FileHeader      64 bytes
+ *  TensorEntry     64 bytes x tensorCount
+ *  payload         every tensor starts on a 64 byte boundary, row-major
+ *
+ * Version 1 stores float64 tensors in the inference layout:
+ *  l1.weight       (320, 128)  input-major: the conv1d weight (128, 40, 8) flattened to (128, 320) and transposed
+ *  l2.weight       (64, 128)
+ *  l2.bias         (64)
+ *  lout.weight     (1, 64)
+ *  lout.bias       (1)
+ */
+namespace eval::nnw {
+
+// the v1 tensors packed one after another, the layout of the csv storage and of the embedded weights
+namespace layout {
+constexpr uint32_t inputs = 320;
+constexpr uint32_t outputs = 128;
+constexpr uint32_t hidden = 64;
+
+constexpr std::size_t l1 = 0;
+constexpr std::size_t l2w = l1 + inputs * outputs;
+constexpr std::size_t l2b = l2w + hidden * outputs;
+constexpr std::size_t outw = l2b + hidden;
+constexpr std::size_t outb = outw + hidden;
+constexpr std::size_t size = outb + 1;
+} // namespace layout
+
+constexpr char magic[8] = {'S', 'G', 'N', 'N', 'W', 'G', 'T', '\0'};
+constexpr uint32_t version = 1;
+constexpr std::size_t alignment = 64;
+
+enum class DType : uint32_t {
+    F64 = 0,
+    F32 = 1,
+};
+
+struct FileHeader {
+    char        magic[8];
+    uint32_t    version;
+    uint32_t    dtype;
+    uint32_t    tensorCount;
+    uint32_t    reserved0;
+    uint64_t    payloadOffset;
+    uint64_t    payloadSize;
+    uint64_t    checksum;       // FNV-1a 64 of the payload bytes
+    uint8_t     reserved1[16];
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct TensorEntry {
+    char        name[32];
+    uint32_t    ndim;
+    uint32_t    shape[3];
+    uint64_t    offset;         // from the file start
+    uint64_t    count;
+};
+static_assert(sizeof(TensorEntry) == 64);
+
+uint64_t checksum(const void* data, std::size_t size) noexcept;
+
+/*
+ * @brief   Peek the magic, tells a binary weight file from the gzip csv one
+ */
+bool isBinaryWeights(const std::string& path) noexcept;
+
+/*
+ * @brief   Read-only mapping of a validated binary weight file (throws std::runtime_error)
+ */
+class MappedWeights {
+public:
+    explicit MappedWeights(const std::string& path);
+    MappedWeights(const MappedWeights&) = delete;
+    MappedWeights& operator=(const MappedWeights&) = delete;
+    ~MappedWeights();
+
+    /*
+     * @brief   float64 tensor of the exact shape, throws if it's missing or has another shape
+     */
+    const double* tensor(std::string_view name, std::initializer_list<uint32_t> shape) const;
+
+private:
+    const uint8_t*  m_data = nullptr;
+    std::size_t     m_size = 0;
+
+    const FileHeader& header_() const noexcept;
+};
+
+struct TensorView {
+    std::string_view        name;
+    std::vector<uint32_t>   shape;
+    const double*           data;
+};
+
+/*
+ * @brief   Write float64 tensors in the binary format (throws std::runtime_error)
+ */
+void save(const std::string& path, const std::vector<TensorView>& tensors);
+
+/*
+ * @brief   Parse the gzip csv of sgtrain/converters.py (sg_convert_weights) into the packed layout
+ */
+std::vector<double> readGzipCsv(const std::string& path);
+
+#ifdef SG_EMBEDDED_NN_WEIGHTS
+// NN_GZIP_PRETRAINED_WEIGHTS in the packed layout, generated by nn_embed at build time
+extern const double embeddedWeights[layout::size];
+#endif
+
+} // namespace eval::nnw
+
+#endif  // INCLUDE_EVAL_NN_WEIGHTS_H_
@@ -4,6 +4,11 @@
 #include "board/board_state.h"
 #include "common/options.h"
 #include <tuple>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <stdexcept>
 #include <boost/python/numpy.hpp>
 #include "eval/evaluator.h"
 
@@ -38,6 +43,26 @@ private:
     interop::CDCMove m_data[64];
 };
 
+/*
+ * Evaluators shared by all the CDCs of the same weights and inference: the weights are loaded once,
+ * and a list of CDCs is scored by one model (its thread accumulator isn't refreshed between them)
+ */
+class SharedEvaluators {
+    struct Entry {
+        explicit Entry(common::Options options) : opts(std::move(options)), evaluator(opts) {}
+        common::Options opts;   // the evaluator keeps a reference
+        eval::NNEvaluator evaluator;
+    };
+public:
+    static eval::NNEvaluator& get(const common::Options& opts) {
+        static std::map<std::pair<std::string, common::NNPrecision>, std::unique_ptr<Entry>> entries;
+        auto& entry = entries[{opts.NNStateFile, opts.NNInference}];
+        if (!entry)
+            entry = std::make_unique<Entry>(opts);
+        return entry->evaluator;
+    }
+};
+
 /*
  * Cross domain communicator
  */
@@ -46,6 +71,13 @@ public:
     explicit CDC(brd::BoardState&& state, common::Options opts) noexcept
     : m_state(std::move(state)), m_opts(std::move(opts)) {}
 
+    /*
+     * @brief   The weights are loaded on the first evaluation of any CDC with the same options
+     */
+    eval::NNEvaluator& evaluator() {
+        return SharedEvaluators::get(m_opts);
+    }
+
 public:
     brd::BoardState m_state;
     common::Options m_opts;
@@ -82,8 +114,8 @@ auto convert_(const interop::CDCMove& cdcMove) noexcept {
 }
 
 static void fillNNLayer(const brd::BoardState::nnLayer_t& nnl, const np::ndarray& input) {
-    auto data = reinterpret_cast<double*>(input.get_data());
-    std::memcpy(data, nnl.data(), brd::nnLayerSize() * sizeof(double));
+    auto data = reinterpret_cast<int8_t*>(input.get_data());
+    std::memcpy(data, nnl.data(), sizeof(brd::BoardState::nnLayer_t));
 }
 
 void makeMove(interop::CDC* cdc, const interop::CDCMove& cdcMove, const np::ndarray& input) {
@@ -137,7 +169,7 @@ interop::CDCMove recognizeMove(const interop::CDC* cdc, uint8_t from, uint8_t to
 np::ndarray initNNLayer() {
     constexpr auto sz= brd::nnLayerSize();
     Py_intptr_t shape[1] = { sz };
-    np::ndarray result = np::zeros(1, shape, np::dtype::get_builtin<double>());
+    np::ndarray result = np::zeros(1, shape, np::dtype::get_builtin<int8_t>());
     return result;
 }
 
@@ -145,9 +177,48 @@ bool isDraw(interop::CDC* cdc) noexcept {
     return cdc->m_state.draw();
 }
 
-double getRawEvaluation(interop::CDC* cdc) noexcept {
-    eval::NNEvaluator evalu(cdc->m_opts);
-    return evalu.evaluateRaw(cdc->m_state);
+double getRawEvaluation(interop::CDC* cdc) {
+    return cdc->evaluator().evaluateRaw(cdc->m_state);
+}
+
+/*
+ * @brief   Raw evaluations of an (N, nnLayerSize) array of NN input planes, the weights of the cdc
+ */
+np::ndarray getRawEvaluations(interop::CDC* cdc, const np::ndarray& inputs) {
+    constexpr auto sz = brd::nnLayerSize();
+    if (inputs.get_nd() != 2 || inputs.shape(1) != sz)
+        throw std::invalid_argument("inputs must be an (N, 320) array");
+
+    // int8 C-contiguous planes are read in place, anything else is converted once
+    const bool inPlace = inputs.get_dtype() == np::dtype::get_builtin<int8_t>()
+        && (inputs.get_flags() & np::ndarray::C_CONTIGUOUS);
+    np::ndarray planes = inPlace ? inputs : inputs.astype(np::dtype::get_builtin<int8_t>());
+    if (!(planes.get_flags() & np::ndarray::C_CONTIGUOUS))
+        planes = planes.copy();
+
+    Py_intptr_t count = inputs.shape(0);
+    Py_intptr_t shape[1] = { count };
+    np::ndarray result = np::empty(1, shape, np::dtype::get_builtin<double>());
+    auto src = reinterpret_cast<const int8_t*>(planes.get_data());
+    auto dst = reinterpret_cast<double*>(result.get_data());
+    cdc->evaluator().evaluateRawBatch(src, static_cast<std::size_t>(count), dst);
+    return result;
+}
+
+/*
+ * @brief   Raw evaluations of the current positions of a list of CDCs, the CDCs of the same
+ *          options share one evaluator
+ */
+np::ndarray getRawEvaluationsOf(const python::list& cdcs) {
+    Py_intptr_t count = python::len(cdcs);
+    Py_intptr_t shape[1] = { count };
+    np::ndarray result = np::empty(1, shape, np::dtype::get_builtin<double>());
+    auto dst = reinterpret_cast<double*>(result.get_data());
+    for (Py_intptr_t i = 0; i < count; i++) {
+        interop::CDC* cdc = python::extract<interop::CDC*>(cdcs[i]);
+        dst[i] = cdc->evaluator().evaluateRaw(cdc->m_state);
+    }
+    return result;
 }
 
 
@@ -182,4 +253,6 @@ BOOST_PYTHON_MODULE(sg_trainer_interop) {
     python::def(OBJECT_NAME(displayBoard), displayBoard);
     python::def(OBJECT_NAME(isDraw), isDraw);
     python::def(OBJECT_NAME(getRawEvaluation), getRawEvaluation);
+    python::def(OBJECT_NAME(getRawEvaluations), getRawEvaluations);
+    python::def(OBJECT_NAME(getRawEvaluationsOf), getRawEvaluationsOf);
 }
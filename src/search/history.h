@@ -0,0 +1,48 @@
+#ifndef INCLUDE_SEARCH_HISTORY_H_
+#define INCLUDE_SEARCH_HISTORY_H_
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "../core/defs.h"
+#include "../board/move.h"
+
+namespace search {
+
+/*
+ * @brief   Quiet move ordering tables kept between the searches: the history scores and
+ *          the countermoves (the quiet move which refuted a move), both by [color][kind][to]
+ */
+struct History {
+    constexpr static int scMax = 16384;
+    constexpr static unsigned scKinds = 7;
+
+    int16_t     scores[2][scKinds][SQ_CNT]{};
+    brd::Move   counters[2][scKinds][SQ_CNT]{};
+
+    /*
+     * @brief   bonus > 0 for the move of a cutoff, < 0 for the quiets searched before it.
+     *          The score saturates towards scMax, so the old cutoffs fade out
+     */
+    void update(PColor color, PKind kind, SQ to, int bonus) noexcept;
+
+    /*
+     * @brief   Between the searches, the scores of the previous position weigh half
+     */
+    void age() noexcept;
+};
+
+inline void History::update(PColor color, PKind kind, SQ to, int bonus) noexcept {
+    int16_t& score = scores[color][kind][to];
+    bonus = std::clamp(bonus, -scMax, scMax);
+    score = static_cast<int16_t>(score + bonus - score * std::abs(bonus) / scMax);
+}
+
+inline void History::age() noexcept {
+    for (auto& byKind : scores)
+        for (auto& byTo : byKind)
+            for (auto& score : byTo) score /= 2;
+}
+
+} // namespace search
+
+#endif  // INCLUDE_SEARCH_HISTORY_H_
@@ -1,5 +1,6 @@
 #include "mtdsearch.h"
 #include "../board/board_state.h"
+#include "../board/move_picker.h"
 #include "tm.h"
 #include "../common/options.h"
 #include "tt.h"
@@ -8,7 +9,10 @@
 #include "../eval/evaluator.h"
 #include "../common/stat.h"
 #include "../core/ThreadPoolExecutor.h"
+#include <algorithm>
+#include <cmath>
 #include <future>
+#include <optional>
 
 
 namespace search {
@@ -18,6 +22,8 @@ struct SearchContext {
     constexpr static unsigned scMaxPly = 64;
 //    unsigned TDepth = 0;
     brd::Move T1[scMaxPly][scMaxPly];
+    brd::Move killers[scMaxPly][2];     // the quiet moves of the last cutoffs by ply
+    int nullMinPly = 0;                 // no null moves above it, while a null move cutoff is verified
     bool pvWasFound[scMaxPly];
     Score interRes = 0;
     void incrementLevel() { relPly++; pvWasFound[relPly] = false; }
@@ -28,19 +34,25 @@ struct SearchContext {
 } // namespace detail
 
 
-static inline auto movegen(bool isEven, const brd::BoardState& state, PColor searchRootColor) {
-    brd::MoveList mvList{};
-    if ((isEven && searchRootColor == PColor::W) || (!isEven && searchRootColor == PColor::B))
-        state.movegenFor<PColor::W>(mvList);
-    else
-        state.movegenFor<PColor::B>(mvList);
-    return mvList;
+static inline PColor sideToMove(bool isEven, PColor searchRootColor) noexcept {
+    return isEven ? searchRootColor : invert(searchRootColor);
+}
+
+static inline bool kingInCheck(const brd::BoardState& state, PColor color) noexcept {
+    return color ? state.kingUnderCheck<PColor::W>() : state.kingUnderCheck<PColor::B>();
 }
 
-template <typename TExecutor>
-MtdSearch<TExecutor>::MtdSearch(common::Options& opts, common::Stat& stat, 
+template <typename TExecutor, typename TMakePolicy>
+MtdSearch<TExecutor, TMakePolicy>::MtdSearch(common::Options& opts, common::Stat& stat, 
         TimeManager& tm, TTable& ttable, eval::Evaluator& eval) noexcept 
-: m_opts(opts), m_stat(stat), m_ttable(ttable), m_tm(tm), m_eval(eval), m_executor(m_opts) {}
+: m_opts(opts), m_stat(stat), m_ttable(ttable), m_tm(tm), m_eval(eval), m_executor(m_opts) {
+    const double base = m_opts.LmrBase / 100.0, divisor = std::max(1u, m_opts.LmrDivisor) / 100.0;
+    for (unsigned d = 0; d < scLmrSize; d++)
+        for (unsigned m = 0; m < scLmrSize; m++) {
+            const double r = d && m ? base + std::log(d) * std::log(m) / divisor : 0.0;
+            m_reductions[d][m] = static_cast<uint8_t>(std::clamp(r, 0.0, static_cast<double>(d)));
+        }
+}
 
 
 static inline auto getCtxs(const common::Options& opts) {
@@ -52,9 +64,12 @@ static inline auto getCtxs(const common::Options& opts) {
 
 
 // todo: fix PVLine
-template <typename TExecutor>
-search::str::Report MtdSearch<TExecutor>::pvMove(brd::BoardState& state) noexcept {
+template <typename TExecutor, typename TMakePolicy>
+search::str::Report MtdSearch<TExecutor, TMakePolicy>::pvMove(brd::BoardState& state) noexcept {
+    // the stats of the last search stay readable until the next one
+    m_stat.resetSingleSearch();
     m_ttable.incrementAge();
+    m_history.age();
 
     detail::SearchContext ctx{};
     Score f1 = 0, f2 = 0;
@@ -74,18 +89,17 @@ search::str::Report MtdSearch<TExecutor>::pvMove(brd::BoardState& state) noexcep
     report.ponder = ctx.T1[0][1];
     std::cout << "pon:" << report.ponder << std::endl;
     SG_ASSERT(!report.pvMove.NAM());
-
-    m_stat.resetSingleSearch();
     return report;
 }
 
 
-template <typename TExecutor>
-Score MtdSearch<TExecutor>::MTDF_(brd::BoardState& state, int16_t f, unsigned depth, detail::SearchContext& ctx) noexcept {
+template <typename TExecutor, typename TMakePolicy>
+Score MtdSearch<TExecutor, TMakePolicy>::MTDF_(brd::BoardState& state, int16_t f, unsigned depth, detail::SearchContext& ctx) noexcept {
 //    brd::Move bestMove{};
     int16_t lowerBound = -INF, upperBound = INF, beta = 0;
     while (lowerBound < upperBound && !m_tm.timeout()) {
         beta = (f == lowerBound) ? f+1 : f;
+        m_stat.MtdPasses++;
         auto [l, p] = AlphaBeta<false>(state, beta-1, beta, depth, true, ctx);
         f = l;
         if (f < beta) upperBound = f;
@@ -100,6 +114,14 @@ static Score checkmateScore(const brd::BoardState& state, PColor engineColor, un
         : static_cast<Score>(CHECKMATE_EVAL - relPly);
 }
 
+/*
+ * The side to move has no legal moves: checkmate if the king is under check, stalemate otherwise
+ */
+static Score noMovesScore(bool inCheck, bool even, unsigned relPly) noexcept {
+    if (!inCheck) return 0x00;
+    return even ? static_cast<Score>(-CHECKMATE_EVAL + relPly) : static_cast<Score>(CHECKMATE_EVAL - relPly);
+}
+
 static void copyPV(detail::SearchContext& ctx, const brd::Move& best, const brd::Move& prevBest) noexcept {
     ctx.T1[ctx.relPly][0] = best;
     if (ctx.prevLevelPvFound()) {
@@ -112,9 +134,19 @@ static void copyPV(detail::SearchContext& ctx, const brd::Move& best, const brd:
     ctx.T1[ctx.relPly][1] = prevBest;
 }
 
-template <typename TExecutor>
+// late move reductions from this depth and from the 4th searched move, by the table of the options
+constexpr static unsigned LMR_MIN_DEPTH = 3;
+constexpr static unsigned LMR_MIN_MOVE_IDX = 3;
+// late move pruning: once the depth dependent count of moves is searched, the quiets are skipped
+// (the non-PV nodes only)
+constexpr static unsigned LMP_MAX_DEPTH = 3;
+static constexpr unsigned lmpMoveCount(unsigned depth) noexcept {
+    return 3 + depth * depth;
+}
+
+template <typename TExecutor, typename TMakePolicy>
 template<bool PV>
-std::pair<Score, brd::Move> MtdSearch<TExecutor>::AlphaBeta(
+std::pair<Score, brd::Move> MtdSearch<TExecutor, TMakePolicy>::AlphaBeta(
         brd::BoardState& state, Score alpha, Score beta, unsigned depth,
         bool even, detail::SearchContext& ctx, bool mainThread) noexcept {
 
@@ -122,6 +154,8 @@ std::pair<Score, brd::Move> MtdSearch<TExecutor>::AlphaBeta(
         if (state.draw()) return {0x00, NONE_MOVE};
         return {checkmateScore(state, m_opts.EngineSide, ctx.relPly), NONE_MOVE};
     }
+    if (!depth)
+        return {quiescence_(state, alpha, beta, even, ctx), NONE_MOVE};
 
     ctx.incrementLevel();
     auto origAlpha = alpha;
@@ -148,36 +182,77 @@ std::pair<Score, brd::Move> MtdSearch<TExecutor>::AlphaBeta(
 
     Score bestScore = even ? -INF : INF;
     int boundType = 0x00;
-    if (!depth) {
-        auto score = eval_(state, ctx.relPly);
-        ttdesc.write(score, EXACT_BND, 0, {});
-        ctx.decrementLevel();
-        return {score, NONE_MOVE};
-    }
 
-    brd::MoveList mvList;
+    brd::Move hashMove = ttdesc.hit() ? ttdesc.entry()->hashMove : NONE_MOVE;
     if constexpr (PV) {
         if (!ctx.T1[0][ctx.relPly].NAM())
-            mvList.push(ctx.T1[0][ctx.relPly]);
-        else mvList = movegen(even, state, m_opts.EngineSide);
+            hashMove = ctx.T1[0][ctx.relPly];
     }
-    else {
-        mvList = movegen(even, state, m_opts.EngineSide);
+
+    if constexpr (!PV) {
+        if (auto cut = nullMove_(state, alpha, beta, depth, even, ctx, mainThread)) {
+            m_stat.NullMoveCuts++;
+            ttdesc.write(*cut, even ? LOWER_BND : UPPER_BND, depth, hashMove);
+            ctx.decrementLevel();
+            return {*cut, NONE_MOVE};
+        }
     }
 
-using spawn_t = std::optional<std::future<std::pair<Score, brd::Move>>>;
-#define SPAWN_COND(mt, ii, d) ((ii) < mvList.size()-1 && m_executor.capacity() && (d) >= 3)
+    const PColor color = sideToMove(even, m_opts.EngineSide);
+    brd::QuietHints hints{};
+    hints.killers[0] = ctx.killers[ctx.relPly][0];
+    hints.killers[1] = ctx.killers[ctx.relPly][1];
+    if (mainThread) {
+        hints.history = m_history.scores[color];
+        if (state.ply() && !state.getLastMove().isNull) {
+            const auto& last = state.getLastMove();
+            hints.counter = m_history.counters[last.moveColor][last.moveKind][last.to];
+        }
+    }
 
-    brd::Move bestMove{};
+    // moves are generated stage by stage, a cutoff skips the rest of the generation
+    brd::MovePicker picker(state, color, hashMove, brd::MG_ALL, hints);
+    brd::Move move = picker.next();
+    if (move.NAM()) {
+        ctx.decrementLevel();
+        auto score = noMovesScore(picker.checkInfo().checkers, even, ctx.relPly);
+        ttdesc.write(score, EXACT_BND, depth, {});
+        return {score, NONE_MOVE};
+    }
 
-    for (std::size_t i=0; i<mvList.size(); i++) {
-        auto move = mvList[i];
+using spawn_t = std::optional<std::future<std::pair<Score, brd::Move>>>;
+#define SPAWN_COND(mt, d) (m_executor.capacity() && (d) >= 3)
 
+    brd::Move bestMove{};
+    // the moves searched before the current one, the spawned ones included and the pruned ones not
+    unsigned moveIdx = 0;
+    constexpr unsigned maxTriedQuiets = 64;
+    brd::Move triedQuiets[maxTriedQuiets];
+    unsigned triedCount = 0;
+    auto markTried = [&](const brd::Move& tried) {
+        if (triedCount < maxTriedQuiets && !state.getBoard().isCaptureOrPromo(tried))
+            triedQuiets[triedCount++] = tried;
+    };
+
+    const bool inCheck = picker.checkInfo().checkers;
+    // MTD(f) searches null windows only, an open window is a full window search of a PV node
+    const bool pvNode = PV || origBeta - origAlpha > 1;
+    for (; !move.NAM(); move = picker.next()) {
         Score score{}; brd::Move prevMove{}; brd::Move spMove{};
         spawn_t spawnFuture;
+        bool quiet = !state.getBoard().isCaptureOrPromo(move);
+
+        // late move pruning: near the horizon the late quiets rarely beat the moves ordered before them,
+        // the checks stay (the mates are quiet moves too)
+        if (quiet && !inCheck && !pvNode && ctx.relPly && depth <= LMP_MAX_DEPTH && moveIdx >= lmpMoveCount(depth)
+            && (even ? bestScore > -MIN_CHECKMATE_EVAL : bestScore < MIN_CHECKMATE_EVAL)) {
+            auto saved = TMakePolicy::make(state, move);
+            const bool givesCheck = kingInCheck(state, sideToMove(!even, m_opts.EngineSide));
+            TMakePolicy::unmake(state, saved);
+            if (!givesCheck) continue;
+        }
 
-        if (SPAWN_COND(mainThread, i, depth)) {
-            spMove = mvList[i+1];
+        if (SPAWN_COND(mainThread, depth) && !(spMove = picker.next()).NAM()) {
             spawnFuture = m_executor.try_send(
                 [this, &spMove,
                     copy_state = state,
@@ -190,21 +265,38 @@ using spawn_t = std::optional<std::future<std::pair<Score, brd::Move>>>;
                 });
         }
 
-        state.registerMove(move);
-        auto [k1, k2] = AlphaBeta<PV>(state, alpha, beta, depth-1, !even, ctx, mainThread);
-        score = k1, prevMove = k2;
-        state.undo();
+        auto saved = TMakePolicy::make(state, move);
+        unsigned reduction = 0;
+        if (quiet && !inCheck && !spawnFuture.has_value() && depth >= LMR_MIN_DEPTH && moveIdx >= LMR_MIN_MOVE_IDX) {
+            // the table is by the move number, the first move is the 1st
+            if (!kingInCheck(state, sideToMove(!even, m_opts.EngineSide)))
+                reduction = std::min<unsigned>(m_reductions[std::min(depth, scLmrSize - 1)][std::min(moveIdx + 1, scLmrSize - 1)],
+                                               depth - 2);
+            // the PV is reduced a ply less
+            if (pvNode && reduction) reduction--;
+        }
+        auto res = AlphaBeta<PV>(state, alpha, beta, depth-1-reduction, !even, ctx, mainThread);
+        // the reduced search beat the bound, it has to be confirmed at the full depth
+        if (reduction && (even ? res.first > alpha : res.first < beta)) {
+            m_stat.LmrReSearches++;
+            res = AlphaBeta<PV>(state, alpha, beta, depth-1, !even, ctx, mainThread);
+        }
+        score = res.first, prevMove = res.second;
+        TMakePolicy::unmake(state, saved);
 
         if (spawnFuture.has_value()) {
             SG_ASSERT(!spMove.NAM());
 
-            i++;
             auto [spScore, spMovePrev] = spawnFuture.value().get();
             if ((even && spScore > score) || (!even && spScore < score)) {
+                // both were searched, the one which didn't win counts as tried
+                markTried(move);
                 score = spScore;
                 prevMove = spMovePrev;
                 move = spMove;
+                quiet = !state.getBoard().isCaptureOrPromo(move);
             }
+            else markTried(spMove);
         }
 
         if (even) {
@@ -224,8 +316,15 @@ using spawn_t = std::optional<std::future<std::pair<Score, brd::Move>>>;
             }
         }
 
-        if (alpha >= beta)
+        if (alpha >= beta) {
+            m_stat.CutNodes++;
+            if (!moveIdx) m_stat.FirstMoveCuts++;
+            if (quiet)
+                onQuietCutoff_(state, move, triedQuiets, triedCount, depth, even, ctx, mainThread);
             break;
+        }
+        markTried(move);
+        moveIdx += spawnFuture.has_value() ? 2 : 1;
     }
 
     if (bestScore <= origAlpha) boundType = UPPER_BND;
@@ -237,8 +336,191 @@ using spawn_t = std::optional<std::future<std::pair<Score, brd::Move>>>;
     return {bestScore, bestMove};
 }
 
-template <typename TExecutor>
-Score MtdSearch<TExecutor>::eval_(brd::BoardState& state, unsigned relPly) noexcept {
+// the reduction grows with the depth, a shallow null search is enough to see that passing holds
+constexpr static unsigned NULL_MOVE_MIN_DEPTH = 3;
+constexpr static unsigned NULL_MOVE_DEEP_R_DEPTH = 7;
+// from this depth a null move cutoff is confirmed by a reduced search of the node itself
+constexpr static unsigned NULL_MOVE_VERIFY_DEPTH = 8;
+
+template <typename TExecutor, typename TMakePolicy>
+std::optional<Score> MtdSearch<TExecutor, TMakePolicy>::nullMove_(
+        brd::BoardState& state, Score alpha, Score beta, unsigned depth,
+        bool even, detail::SearchContext& ctx, bool mainThread) noexcept {
+    if (depth < NULL_MOVE_MIN_DEPTH || !ctx.relPly || ctx.relPly < ctx.nullMinPly)
+        return std::nullopt;
+    if (!state.ply() || state.getLastMove().isNull)
+        return std::nullopt;
+
+    const PColor color = sideToMove(even, m_opts.EngineSide);
+    // zugzwang guard: with the king and pawns only, passing may be better than any move
+    if (!state.pieceMaterial(color))
+        return std::nullopt;
+    if (kingInCheck(state, color))
+        return std::nullopt;
+    const Score staticEval = eval_(state, ctx.relPly);
+    if (even ? staticEval < beta : staticEval > alpha)
+        return std::nullopt;
+
+    const unsigned R = depth >= NULL_MOVE_DEEP_R_DEPTH ? 3 : 2;
+    const unsigned nullDepth = depth - 1 - R;
+    state.makeNull();
+    Score score = even
+        ? AlphaBeta<false>(state, beta - 1, beta, nullDepth, !even, ctx, mainThread).first
+        : AlphaBeta<false>(state, alpha, alpha + 1, nullDepth, !even, ctx, mainThread).first;
+    state.undoNull();
+
+    if (even ? score < beta : score > alpha)
+        return std::nullopt;
+    // a mate seen after passing isn't proven
+    if (score >= MIN_CHECKMATE_EVAL || score <= -MIN_CHECKMATE_EVAL)
+        score = even ? beta : alpha;
+    if (depth < NULL_MOVE_VERIFY_DEPTH)
+        return score;
+
+    // the same node at the null search depth, without null moves for the next plies
+    const int nullMinPly = ctx.nullMinPly;
+    ctx.nullMinPly = ctx.relPly + static_cast<int>(3 * nullDepth / 4);
+    ctx.decrementLevel();
+    const Score verified = AlphaBeta<false>(state, alpha, beta, nullDepth, even, ctx, mainThread).first;
+    ctx.incrementLevel();
+    ctx.nullMinPly = nullMinPly;
+
+    if (even ? verified < beta : verified > alpha)
+        return std::nullopt;
+    return score;
+}
+
+template <typename TExecutor, typename TMakePolicy>
+void MtdSearch<TExecutor, TMakePolicy>::onQuietCutoff_(
+        const brd::BoardState& state, const brd::Move& move, const brd::Move* triedQuiets,
+        unsigned triedCount, unsigned depth, bool even, detail::SearchContext& ctx, bool mainThread) noexcept {
+    auto& killers = ctx.killers[ctx.relPly];
+    if (!(killers[0] == move)) {
+        killers[1] = killers[0];
+        killers[0] = move;
+    }
+    if (!mainThread) return;
+
+    const auto& board = state.getBoard();
+    const PColor color = sideToMove(even, m_opts.EngineSide);
+    const int bonus = static_cast<int>(depth * depth);
+    m_history.update(color, board.kindAt(move.from), move.to, bonus);
+    // the quiets searched before didn't cut
+    for (unsigned i = 0; i < triedCount; i++)
+        m_history.update(color, board.kindAt(triedQuiets[i].from), triedQuiets[i].to, -bonus);
+
+    if (state.ply() && !state.getLastMove().isNull) {
+        const auto& last = state.getLastMove();
+        m_history.counters[last.moveColor][last.moveKind][last.to] = move;
+    }
+}
+
+// a capture is skipped if even winning the piece plus the margin doesn't reach the window
+constexpr static Score DELTA_MARGIN_PAWNS = 2;
+
+template <typename TExecutor, typename TMakePolicy>
+Score MtdSearch<TExecutor, TMakePolicy>::quiescence_(
+        brd::BoardState& state, Score alpha, Score beta, bool even, detail::SearchContext& ctx) noexcept {
+
+    if (state.gameover()) {
+        if (state.draw()) return 0x00;
+        return checkmateScore(state, m_opts.EngineSide, ctx.relPly);
+    }
+    if (ctx.relPly + 1 >= static_cast<int>(detail::SearchContext::scMaxPly))
+        return eval_(state, ctx.relPly);
+
+    ctx.incrementLevel();
+    m_stat.QNodes++;
+    const auto origAlpha = alpha;
+    const auto origBeta = beta;
+
+    // any entry is at least as deep as the quiescence: a miss claims no slot (the interior
+    // entries and their hash moves stay) and the write goes over the horizon 0 entries only
+    TTDescriptor ttdesc = m_ttable.probe(state.getBoard().key(), false);
+    brd::Move hashMove = NONE_MOVE;
+    if (ttdesc.hit()) {
+        auto entry = ttdesc.entry();
+        hashMove = entry->hashMove;
+        if (entry->bound == EXACT_BND) {
+            ctx.decrementLevel();
+            return entry->score;
+        }
+
+        if (entry->bound & LOWER_BND) alpha = std::max(alpha, entry->score);
+        else beta = std::min(beta, entry->score);
+
+        if (alpha >= beta) {
+            ctx.decrementLevel();
+            return entry->score;
+        }
+    }
+    auto store = [&](Score score, const brd::Move& move) {
+        // read at the write, the slot may have been taken by the nodes below
+        if (ttdesc.entry()->bound && ttdesc.entry()->horizon) return;
+        int boundType = EXACT_BND;
+        if (score <= origAlpha) boundType = UPPER_BND;
+        else if (score >= origBeta) boundType = LOWER_BND;
+        ttdesc.write(score, boundType, 0, move);
+    };
+
+    brd::MovePicker picker(state, sideToMove(even, m_opts.EngineSide), hashMove, brd::MG_CAPTURES);
+    const bool inCheck = picker.checkInfo().checkers;
+    Score bestScore = even ? -INF : INF;
+    Score standPat = 0;
+    if (!inCheck) {
+        // the side to move isn't forced to capture
+        standPat = bestScore = eval_(state, ctx.relPly);
+        if (even ? standPat >= beta : standPat <= alpha) {
+            store(standPat, NONE_MOVE);
+            ctx.decrementLevel();
+            return standPat;
+        }
+        if (even) alpha = std::max(alpha, standPat);
+        else beta = std::min(beta, standPat);
+    }
+
+    const auto& board = state.getBoard();
+    const int pawn = m_eval.pawnScore();
+    brd::Move bestMove{};
+    bool anyMove = false;
+    for (brd::Move move = picker.next(); !move.NAM(); move = picker.next()) {
+        anyMove = true;
+        if (!inCheck) {
+            const PKind victim = move.isEnpass ? PKind::pP : board.kindAt(move.to);
+            int gain = PieceScores[static_cast<unsigned>(victim)] + DELTA_MARGIN_PAWNS;
+            if (board.kindAt(move.from) == PKind::pP && ((1ull << move.to) & (NRank::r1 | NRank::r8)))
+                gain += QUEEN_SCORE - PAWN_SCORE;
+            if (even ? standPat + gain * pawn <= alpha : standPat - gain * pawn >= beta)
+                continue;
+            if (victim != PKind::None && !board.seeGE(move, 0))
+                continue;
+        }
+
+        auto saved = TMakePolicy::make(state, move);
+        Score score = quiescence_(state, alpha, beta, !even, ctx);
+        TMakePolicy::unmake(state, saved);
+
+        if (even) {
+            if (bestScore < score) bestScore = score, bestMove = move;
+            alpha = std::max(alpha, score);
+        }
+        else {
+            if (bestScore > score) bestScore = score, bestMove = move;
+            beta = std::min(beta, score);
+        }
+        if (alpha >= beta)
+            break;
+    }
+
+    ctx.decrementLevel();
+    if (inCheck && !anyMove)
+        bestScore = noMovesScore(true, even, ctx.relPly);
+    store(bestScore, bestMove);
+    return bestScore;
+}
+
+template <typename TExecutor, typename TMakePolicy>
+Score MtdSearch<TExecutor, TMakePolicy>::eval_(brd::BoardState& state, unsigned relPly) noexcept {
     Score eval;
     if (state.checkmate(m_opts.EngineSide))
         eval = static_cast<Score>(-CHECKMATE_EVAL + relPly);
@@ -253,4 +535,5 @@ Score MtdSearch<TExecutor>::eval_(brd::BoardState& state, unsigned relPly) noexc
 
 template class search::MtdSearch<exec::CallerThreadExecutor>;
 template class search::MtdSearch<exec::ThreadPoolExecutor>;
+template class search::MtdSearch<exec::CallerThreadExecutor, brd::CopyMake>;
 } // namespace search
@@ -2,8 +2,10 @@
 #define INCLUDE_SEARCH_MTDSEARCH_H_
 
 #include "../board/move.h"
+#include "history.h"
+#include <optional>
 namespace common { struct Options; struct Stat; }
-namespace brd { class BoardState; class Board; }
+namespace brd { class BoardState; class Board; struct MakeUnmake; }
 namespace eval { class Evaluator; }
 
 namespace search {
@@ -18,7 +20,10 @@ struct Report {
 class TimeManager;
 class TTable;
 namespace detail { struct SearchContext; }
-template<typename TExecutor>
+/*
+ * @brief   TMakePolicy reverts the searched moves: brd::MakeUnmake or brd::CopyMake
+ */
+template<typename TExecutor, typename TMakePolicy = brd::MakeUnmake>
 class MtdSearch {
 public:
     explicit MtdSearch(
@@ -35,6 +40,11 @@ private:
     TimeManager&        m_tm;
     eval::Evaluator&    m_eval;
     TExecutor           m_executor;
+    // the main thread's only, the tasks of the parallel split order the quiets by their killers
+    History             m_history;
+    // late move reductions by [depth][move number], built from the options
+    constexpr static unsigned scLmrSize = 64;
+    uint8_t             m_reductions[scLmrSize][scLmrSize];
     // const book*                 m_book;
     // const tracer<TExecutor>*    m_tracer;
 
@@ -43,7 +53,21 @@ private:
         brd::BoardState& state, Score alpha, Score beta, unsigned depth, bool even,
         detail::SearchContext& ctx, bool mainThread = true) noexcept;
 
+    /*
+     * @brief   Null move pruning: the cutoff score if the side to move still fails high after
+     *          passing (verified by a reduced search at high depth), nothing otherwise
+     */
+    std::optional<Score> nullMove_(brd::BoardState& state, Score alpha, Score beta, unsigned depth,
+                                   bool even, detail::SearchContext&, bool mainThread) noexcept;
+    void onQuietCutoff_(const brd::BoardState& state, const brd::Move& move, const brd::Move* triedQuiets,
+                        unsigned triedCount, unsigned depth, bool even, detail::SearchContext&, bool mainThread) noexcept;
     Score MTDF_(brd::BoardState& state, Score f, unsigned depth, detail::SearchContext&) noexcept;
+
+    /*
+     * @brief   Captures only search below the horizon: stand-pat, delta and SEE pruning
+     *          (all the evasions when in check)
+     */
+    Score quiescence_(brd::BoardState& state, Score alpha, Score beta, bool even, detail::SearchContext&) noexcept;
     Score eval_(brd::BoardState&, unsigned relPly) noexcept;
 };
 
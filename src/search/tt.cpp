@@ -9,14 +9,15 @@ namespace search {
 
 TTable::TTable(const common::Options& opts, common::Stat& stat) noexcept 
     : m_size(opts.AvailMemTT * 1024/sizeof(TTChain)), m_stat(stat), m_age(0) {
-    m_ttable = new TTChain[m_size];
+    // zeroed, an entry left from the previous owner of the memory would be a hit
+    m_ttable = new TTChain[m_size]();
 }
 
 TTable::~TTable() { delete[] m_ttable; }
 
 
 // todo: is key32 -> key16 possible?
-auto TTable::probe(uint64_t key) noexcept -> TTDescriptor {
+auto TTable::probe(uint64_t key, bool claim) noexcept -> TTDescriptor {
     std::size_t idx = key % m_size;
     TTChain& chain = m_ttable[idx];
     bool occ;
@@ -36,18 +37,33 @@ auto TTable::probe(uint64_t key) noexcept -> TTDescriptor {
     }
 
     if(!ent) {
-        ent = &m_ttable[idx].entries[0];
-        for (unsigned i=1; i<std::size(m_ttable[idx].entries); i++) {
-            if (ent->age < m_ttable[idx].entries[i].age)
-                ent = &m_ttable[idx].entries[i];
+        ent = replaced_(chain);
+        // claimed for this key, a probe before the write mustn't read the evicted entry
+        if (claim) {
+            ent->key = key32;
+            ent->bound = 0x00;
         }
-        ent->key = key32;
     }
 
-    return TTDescriptor(ent, m_age, bound, chain);
+    return TTDescriptor(ent, key32, m_age, bound, chain);
+}
+
+// an empty entry first, then the one of the oldest search and the shallowest of them
+TTEntry* TTable::replaced_(TTChain& chain) const noexcept {
+    auto worth = [this](const TTEntry& entry) {
+        if (!entry.bound) return -1024;
+        return static_cast<int>(entry.horizon) - 64 * static_cast<uint8_t>(m_age - entry.age);
+    };
+    TTEntry* ent = &chain.entries[0];
+    for (auto& entry : chain.entries) {
+        if (worth(entry) < worth(*ent))
+            ent = &entry;
+    }
+    return ent;
 }
 
 void TTDescriptor::write(Score score, int boundType, unsigned depth, const brd::Move& move) noexcept {
+    m_handle->key = m_key;
     m_handle->score = score;
     m_handle->age = m_age;
     m_handle->bound = boundType;
@@ -34,8 +34,8 @@ struct TTChain {
 static_assert(sizeof(TTChain) == 40, "Packer Move Size");
 
 struct TTDescriptor {
-    explicit TTDescriptor(TTEntry* hdl, uint8_t gen, uint8_t bound, TTChain& chain) noexcept
-        : m_bound(bound), m_handle(hdl), m_age(gen), m_chain(chain) {}
+    explicit TTDescriptor(TTEntry* hdl, uint32_t key, uint8_t gen, uint8_t bound, TTChain& chain) noexcept
+        : m_bound(bound), m_handle(hdl), m_key(key), m_age(gen), m_chain(chain) {}
 
     bool hit() const noexcept { return static_cast<bool>(m_bound); }
     void write(Score score, int boundType, unsigned depth, const brd::Move& move) noexcept;
@@ -45,6 +45,8 @@ struct TTDescriptor {
 private:
     uint8_t     m_bound;
     TTEntry*    m_handle;
+    // the probed key, the slot may be claimed by a deeper probe before the write
+    uint32_t    m_key;
     uint8_t     m_age;
     TTChain&    m_chain;
 };
@@ -56,7 +58,11 @@ public:
     explicit TTable(const common::Options& opts, common::Stat& stat) noexcept;
     ~TTable();
 
-    TTDescriptor probe(uint64_t key) noexcept;
+    /*
+     * @brief   On a miss the replaced entry is claimed for the key unless claim is false,
+     *          the quiescence doesn't claim and writes over the horizon 0 entries only
+     */
+    TTDescriptor probe(uint64_t key, bool claim = true) noexcept;
     void incrementAge() noexcept;
 private:
     TTChain*        m_ttable; // the handle chain
@@ -64,6 +70,7 @@ private:
     common::Stat&   m_stat;
     uint8_t         m_age; // generation
 
+    TTEntry* replaced_(TTChain& chain) const noexcept;
 };
 
 } // namespace search
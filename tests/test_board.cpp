@@ -66,4 +66,52 @@ BOOST_AUTO_TEST_CASE(test_kill) {
 
 
 
+BOOST_AUTO_TEST_CASE(test_piece_masks_kernels) {
+    brd::Board board{};
+    board.slideTo(12, 28);
+    board.kill(57);
+    board.put(PKind::pQ, PColor::B, 44);
+
+    auto [col, nbk, pbq, rqk] = board.getRawBoard();
+    const brd::QuadBB q{col, pbq, nbk, rqk};
+    const auto pm = board.pieceMasks();
+    const auto pmScalar = brd::qbb::scalar::pieceMasks(q);
+
+    BOOST_CHECK_EQUAL(pm.masks[PColor::W][PKind::pP], (board.getPieceSqMask<PColor::W, PKind::pP>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::W][PKind::pK], (board.getPieceSqMask<PColor::W, PKind::pK>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::W][PKind::pQ], (board.getPieceSqMask<PColor::W, PKind::pQ>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::B][PKind::pB], (board.getPieceSqMask<PColor::B, PKind::pB>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::B][PKind::pN], (board.getPieceSqMask<PColor::B, PKind::pN>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::B][PKind::pR], (board.getPieceSqMask<PColor::B, PKind::pR>()));
+    BOOST_CHECK_EQUAL(pm.masks[PColor::B][PKind::pQ], 1ull << 44 | 1ull << 59);
+    for (int c = 0; c < 2; c++)
+        for (int k = 0; k < 7; k++)
+            BOOST_CHECK_EQUAL(pm.masks[c][k], pmScalar.masks[c][k]);
+
+#ifdef __AVX2__
+    // the kernel namespace takes the scalar plane updates, the AVX2 ones are checked against them here
+    const auto pmAvx2 = brd::qbb::avx2::pieceMasks(q);
+    for (int c = 0; c < 2; c++)
+        for (int k = 0; k < 7; k++)
+            BOOST_CHECK_EQUAL(pmAvx2.masks[c][k], pmScalar.masks[c][k]);
+
+    auto same = [](const brd::QuadBB& s, const brd::QuadBB& v) {
+        return s.col == v.col && s.pbq == v.pbq && s.nbk == v.nbk && s.rqk == v.rqk;
+    };
+    BOOST_CHECK(same(brd::qbb::scalar::slide(q, 1ull << 1, 1ull << 18, PKind::pN, PColor::W),
+                     brd::qbb::avx2::slide(q, 1ull << 1, 1ull << 18, PKind::pN, PColor::W)));
+    BOOST_CHECK(same(brd::qbb::scalar::slide(q, 1ull << 59, 1ull << 35, PKind::pQ, PColor::B),
+                     brd::qbb::avx2::slide(q, 1ull << 59, 1ull << 35, PKind::pQ, PColor::B)));
+    BOOST_CHECK(same(brd::qbb::scalar::clear(q, 1ull << 4 | 1ull << 60),
+                     brd::qbb::avx2::clear(q, 1ull << 4 | 1ull << 60)));
+    for (int k = PKind::pP; k <= PKind::pR; k++)
+        for (PColor color : {PColor::W, PColor::B}) {
+            const auto kind = static_cast<PKind>(k);
+            BOOST_CHECK(same(brd::qbb::scalar::put(brd::qbb::scalar::clear(q, 1ull << 52), 1ull << 52, kind, color),
+                             brd::qbb::avx2::put(brd::qbb::avx2::clear(q, 1ull << 52), 1ull << 52, kind, color)));
+        }
+#endif
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
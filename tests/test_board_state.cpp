@@ -1,5 +1,6 @@
 #include "board/move.h"
 #include "board/movegen.h"
+#include "board/move_picker.h"
 #include "dbg/debugger.h"
 #include "test_utils.h"
 #include <board/board.h>
@@ -9,6 +10,8 @@
 #include <boost/test/unit_test_suite.hpp>
 
 #include <dbg/debugger.h>
+#include <uci/fen.h>
+#include <core/scores.h>
 
 struct BoardStateFixture {
 public:
@@ -499,7 +502,312 @@ BOOST_FIXTURE_TEST_CASE(test_run_game_check_consistent_nn_layer, BoardStateFixtu
 }
 
 
+/* the layer is built lazily, so a board edited by the FEN loader is picked up as well */
+BOOST_FIXTURE_TEST_CASE(test_nn_layer_after_fen, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("rnbqkbnr/pppp1ppp/8/4p3/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1", state);
+
+    brd::BoardState::nnLayer_t refData{};
+    rebuildNNLayer(state, refData);
+    BOOST_CHECK(!checkDouble(refData, state.getNNL()));
+    BOOST_CHECK_EQUAL(state.getNNL()[128 + SqNum::sqn_e5], 7);
+    BOOST_CHECK_EQUAL(state.getNNL()[288], 1);
+
+    state.registerMove(brd::mkMove(SqNum::sqn_g8, SqNum::sqn_f6));
+    BOOST_CHECK_EQUAL(state.getNNL()[256], 1);
+    BOOST_CHECK_EQUAL(state.getNNL()[288], 0);
+    BOOST_CHECK_EQUAL(state.getNNL()[64 + SqNum::sqn_f6], 11);
+}
+
+
+template<typename Policy = brd::MakeUnmake>
+static uint64_t legalPerft(brd::BoardState& state, unsigned depth, bool white) {
+    brd::MoveList mvList{};
+    if (white) state.legalMovegenFor<PColor::W>(mvList);
+    else state.legalMovegenFor<PColor::B>(mvList);
+    if (depth == 1) return mvList.size();
+
+    uint64_t nodes = 0;
+    for (std::size_t i=0; i<mvList.size(); i++) {
+        auto saved = Policy::make(state, mvList[i]);
+        nodes += legalPerft<Policy>(state, depth-1, !white);
+        Policy::unmake(state, saved);
+    }
+    return nodes;
+}
+
+BOOST_FIXTURE_TEST_CASE(test_legal_perft_init_position, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    BOOST_CHECK_EQUAL(legalPerft(state, 1, true), 20);
+    BOOST_CHECK_EQUAL(legalPerft(state, 2, true), 400);
+    BOOST_CHECK_EQUAL(legalPerft(state, 3, true), 8902);
+    BOOST_CHECK_EQUAL(legalPerft(state, 4, true), 197281);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_legal_perft_kiwipete, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", state);
+    BOOST_CHECK_EQUAL(legalPerft(state, 1, true), 48);
+    BOOST_CHECK_EQUAL(legalPerft(state, 2, true), 2039);
+    BOOST_CHECK_EQUAL(legalPerft(state, 3, true), 97862);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_legal_perft_copy_make, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", state);
+    const auto key = state.getBoard().key();
+    BOOST_CHECK_EQUAL(legalPerft<brd::CopyMake>(state, 3, true), 97862);
+    BOOST_CHECK_EQUAL(state.getBoard().key(), key);
+    BOOST_CHECK_EQUAL(state.ply(), 0);
+}
+
+/* pins, discovered checks and the enpassant along the king rank */
+BOOST_FIXTURE_TEST_CASE(test_legal_perft_pins_and_enpassant, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", state);
+    BOOST_CHECK_EQUAL(legalPerft(state, 1, true), 14);
+    BOOST_CHECK_EQUAL(legalPerft(state, 2, true), 191);
+    BOOST_CHECK_EQUAL(legalPerft(state, 3, true), 2812);
+    BOOST_CHECK_EQUAL(legalPerft(state, 4, true), 43238);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_legal_movegen_checkmate, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    state.registerMove(brd::mkMove(SqNum::sqn_f2, SqNum::sqn_f3));
+    state.registerMove(brd::mkMove(SqNum::sqn_e7, SqNum::sqn_e5));
+    state.registerMove(brd::mkMove(SqNum::sqn_g2, SqNum::sqn_g4));
+    state.registerMove(brd::mkMove(SqNum::sqn_d8, SqNum::sqn_h4));
 
+    brd::MoveList mvList{};
+    auto ci = state.legalMovegenFor<PColor::W>(mvList);
+
+    BOOST_CHECK_EQUAL(mvList.size(), 0);
+    BOOST_CHECK_EQUAL(ci.checkers, 1ull << SqNum::sqn_h4);
+}
+
+/* Test state:
+ *  k . . . . . . .
+ *  . . . . . . . .
+ *  . Q . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . K . . .
+ */
+BOOST_FIXTURE_TEST_CASE(test_legal_movegen_stalemate, BoardStateFixture) {
+    brd::Board board{};
+    preserveOnlyPositions(board, {W_KING_POS, B_KING_POS, W_QUEEN_POS});
+    brd::BoardState state(std::move(board));
+    state.registerMove(brd::mkMove(B_KING_POS, SqNum::sqn_a8));
+    state.registerMove(brd::mkMove(W_QUEEN_POS, SqNum::sqn_b6));
+
+    brd::MoveList mvList{};
+    auto ci = state.legalMovegenFor<PColor::B>(mvList);
+
+    BOOST_CHECK_EQUAL(mvList.size(), 0);
+    BOOST_CHECK_EQUAL(ci.checkers, 0x00);
+}
+
+/* Test state:
+ *  . . . . k . . .
+ *  . . . . r . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . . . . .
+ *  . . . . Q . K .
+ */
+BOOST_FIXTURE_TEST_CASE(test_legal_movegen_pinned_piece, BoardStateFixture) {
+    brd::Board board{};
+    preserveOnlyPositions(board, {});
+    board.put(PKind::pK, PColor::B, SqNum::sqn_e8);
+    board.put(PKind::pR, PColor::B, SqNum::sqn_e7);
+    board.put(PKind::pQ, PColor::W, SqNum::sqn_e1);
+    board.put(PKind::pK, PColor::W, SqNum::sqn_g1);
+    brd::BoardState state(std::move(board));
+
+    brd::MoveList mvList{};
+    auto ci = state.legalMovegenFor<PColor::B>(mvList);
+    BOOST_CHECK_EQUAL(ci.pinned, 1ull << SqNum::sqn_e7);
+
+    while (mvList.size()) {
+        auto move = mvList.pop();
+        if (move.from == SqNum::sqn_e7)
+            BOOST_CHECK(AS_BB(move.to) & NFile::fE);
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_move_picker_stages, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", state);
+
+    brd::MoveList legal{};
+    state.legalMovegenFor<PColor::W>(legal);
+
+    const auto hashMove = brd::mkMove(SqNum::sqn_a2, SqNum::sqn_a3);
+    brd::MovePicker picker(state, PColor::W, hashMove);
+    BOOST_CHECK(picker.next() == hashMove);
+
+    std::size_t cnt = 1;
+    bool quietsStarted = false;
+    for (auto move = picker.next(); !move.NAM(); move = picker.next(), cnt++) {
+        BOOST_CHECK(!(move == hashMove));
+        bool capture = !move.castling && (!state.getBoard().empty(move.to) || move.isEnpass);
+        if (!capture) quietsStarted = true;
+        else BOOST_CHECK(!quietsStarted);
+    }
+
+    BOOST_CHECK_EQUAL(cnt, legal.size());
+}
+
+BOOST_FIXTURE_TEST_CASE(test_move_picker_skips_illegal_hash_move, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    brd::MovePicker picker(state, PColor::W, brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e5));
+
+    std::size_t cnt = 0;
+    for (auto move = picker.next(); !move.NAM(); move = picker.next()) cnt++;
+    BOOST_CHECK_EQUAL(cnt, 20);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_move_picker_mvv_lva, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    // the a3 knight, the d5 queen and the f5 rook are en prise, the rook can be taken by a pawn or the queen
+    fen.apply("4k3/8/8/3q1r2/2P1P1Q1/n7/8/R3K3 w - - 0 1", state);
+    const auto& board = state.getBoard();
+
+    brd::MovePicker picker(state, PColor::W, NONE_MOVE);
+    std::vector<std::pair<int, int>> captures;      // (victim, attacker) values in the picked order
+    for (auto move = picker.next(); !move.NAM(); move = picker.next()) {
+        if (board.kindAt(move.to) == PKind::None) break;
+        captures.emplace_back(PieceScores[board.kindAt(move.to)], PieceScores[board.kindAt(move.from)]);
+    }
+
+    BOOST_REQUIRE_EQUAL(captures.size(), 5);
+    BOOST_CHECK(captures[0] == std::make_pair(QUEEN_SCORE, PAWN_SCORE));
+    BOOST_CHECK(captures[1] == std::make_pair(QUEEN_SCORE, PAWN_SCORE));
+    BOOST_CHECK(captures[2] == std::make_pair(ROOK_SCORE, PAWN_SCORE));
+    BOOST_CHECK(captures[3] == std::make_pair(ROOK_SCORE, QUEEN_SCORE));
+    BOOST_CHECK(captures[4] == std::make_pair(KNIGHT_SCORE, ROOK_SCORE));
+}
+
+BOOST_FIXTURE_TEST_CASE(test_move_picker_quiet_hints, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+
+    int16_t history[7][SQ_CNT]{};
+    history[PKind::pN][SqNum::sqn_f3] = 100;
+    history[PKind::pP][SqNum::sqn_d4] = 50;
+    brd::QuietHints hints{};
+    hints.killers[0] = brd::mkMove(SqNum::sqn_h2, SqNum::sqn_h3);
+    hints.killers[1] = brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e5);     // not a move here, ignored
+    hints.counter = brd::mkMove(SqNum::sqn_a2, SqNum::sqn_a4);
+    hints.history = history;
+
+    brd::MovePicker picker(state, PColor::W, NONE_MOVE, brd::MG_ALL, hints);
+    BOOST_CHECK(picker.next() == hints.killers[0]);
+    BOOST_CHECK(picker.next() == hints.counter);
+    BOOST_CHECK(picker.next() == brd::mkMove(SqNum::sqn_g1, SqNum::sqn_f3));
+    BOOST_CHECK(picker.next() == brd::mkMove(SqNum::sqn_d2, SqNum::sqn_d4));
+
+    std::size_t cnt = 4;
+    for (auto move = picker.next(); !move.NAM(); move = picker.next()) cnt++;
+    BOOST_CHECK_EQUAL(cnt, 20);
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_slider_backends_match, BoardStateFixture) {
+    if (!movegen::pextSupported()) return;
+
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    auto rnd = [&seed] { seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17; return seed; };
+    for (int i = 0; i < 2000; i++) {
+        const BB occupied = rnd() & rnd();
+        for (SQ sq = 0; sq < SQ_CNT; sq++) {
+            movegen::setSliderBackend(movegen::SliderBackend::Magic);
+            const BB rook = movegen::getRookOccupancy(sq, occupied);
+            const BB bishop = movegen::getBishopOccupancy(sq, occupied);
+            movegen::setSliderBackend(movegen::SliderBackend::Pext);
+            BOOST_REQUIRE_EQUAL(movegen::getRookOccupancy(sq, occupied), rook);
+            BOOST_REQUIRE_EQUAL(movegen::getBishopOccupancy(sq, occupied), bishop);
+        }
+    }
+    movegen::setSliderBackend(movegen::SliderBackend::Auto);
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_attackers_to_square, BoardStateFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    // e5: attacked by the d4 pawn, the d3 knight, the b2 bishop (x-ray through d4) and the f6/d6 black pawns
+    fen.apply("4k3/8/3p1p2/4r3/3P4/3N4/1B6/4K3 w - - 0 1", state);
+    const auto& board = state.getBoard();
+
+    const BB attackers = board.attackersTo(SqNum::sqn_e5);
+    BOOST_CHECK_EQUAL(attackers, (1ull << SqNum::sqn_d4) | (1ull << SqNum::sqn_d3)
+            | (1ull << SqNum::sqn_d6) | (1ull << SqNum::sqn_f6));
+    // the d4 pawn removed from the occupancy uncovers the bishop
+    const BB xray = board.attackersTo(SqNum::sqn_e5, board.occupancy() & ~(1ull << SqNum::sqn_d4));
+    BOOST_CHECK(xray & (1ull << SqNum::sqn_b2));
+    BOOST_CHECK(!(xray & (1ull << SqNum::sqn_d4)));
+
+    BOOST_CHECK(board.isSquareAttacked(SqNum::sqn_e5, PColor::W));
+    BOOST_CHECK(board.isSquareAttacked(SqNum::sqn_e5, PColor::B));
+    // the e5 rook gives check along the e file
+    BOOST_CHECK(state.kingUnderCheck<PColor::W>());
+    BOOST_CHECK(!state.kingUnderCheck<PColor::B>());
+    BOOST_CHECK(board.isSquareAttacked(SqNum::sqn_d2, PColor::W));     // by the king
+    BOOST_CHECK(!board.isSquareAttacked(SqNum::sqn_a8, PColor::W));
+    BOOST_CHECK(!board.isSquareAttacked(SqNum::sqn_h1, PColor::B));
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_static_exchange, BoardStateFixture) {
+    uci::Fen fen;
+    auto seeOf = [&fen](const char* pos, SQ from, SQ to) {
+        brd::BoardState state(brd::Board{});
+        fen.apply(pos, state);
+        const auto move = brd::mkMove(from, to);
+        const Score value = state.getBoard().see(move);
+        BOOST_CHECK(state.getBoard().seeGE(move, value));
+        BOOST_CHECK(!state.getBoard().seeGE(move, value + 1));
+        return value;
+    };
+
+    // undefended pawn
+    BOOST_CHECK_EQUAL(seeOf("6k1/8/8/4p3/8/8/8/4R1K1 w - - 0 1", SqNum::sqn_e1, SqNum::sqn_e5), PAWN_SCORE);
+    // the pawn is defended by a rook
+    BOOST_CHECK_EQUAL(seeOf("4r1k1/8/8/4p3/8/8/4R3/6K1 w - - 0 1", SqNum::sqn_e2, SqNum::sqn_e5),
+                      PAWN_SCORE - ROOK_SCORE);
+    // the second rook behind on the file (x-ray) makes the recapture losing
+    BOOST_CHECK_EQUAL(seeOf("4r1k1/8/8/4p3/8/8/4R3/4R1K1 w - - 0 1", SqNum::sqn_e2, SqNum::sqn_e5), PAWN_SCORE);
+    // pawn takes a pawn defended by a queen, the queen takes back
+    BOOST_CHECK_EQUAL(seeOf("6k1/8/4q3/3p4/4P3/8/8/6K1 w - - 0 1", SqNum::sqn_e4, SqNum::sqn_d5), 0);
+    // queen takes a pawn defended by a pawn
+    BOOST_CHECK_EQUAL(seeOf("6k1/8/4p3/3p4/8/8/3Q4/6K1 w - - 0 1", SqNum::sqn_d2, SqNum::sqn_d5),
+                      PAWN_SCORE - QUEEN_SCORE);
+    // the king can't recapture on a defended square
+    BOOST_CHECK_EQUAL(seeOf("8/8/8/3k4/4p3/8/5N2/4R1K1 w - - 0 1", SqNum::sqn_f2, SqNum::sqn_e4), PAWN_SCORE);
+    BOOST_CHECK_EQUAL(seeOf("8/8/8/3k4/4p3/8/5N2/6K1 w - - 0 1", SqNum::sqn_f2, SqNum::sqn_e4),
+                      PAWN_SCORE - KNIGHT_SCORE);
+
+    brd::BoardState state(brd::Board{});
+    fen.apply("4r1k1/8/8/4p3/8/8/4R3/6K1 w - - 0 1", state);
+    const auto& board = state.getBoard();
+    const auto capture = brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e5);
+    BOOST_CHECK(board.seeGE(capture, PAWN_SCORE - ROOK_SCORE));
+    BOOST_CHECK(!board.seeGE(capture, 0));
+    // a quiet move to a safe square
+    BOOST_CHECK(board.seeGE(brd::mkMove(SqNum::sqn_e2, SqNum::sqn_d2), 0));
+    BOOST_CHECK(!board.seeGE(brd::mkMove(SqNum::sqn_e2, SqNum::sqn_d2), 1));
+}
 
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -5,11 +5,97 @@
 #include <unordered_set>
 #include <board/board.h>
 #include <eval/evaluator.h>
+#include <eval/nn_weights.h>
 #include <common/options.h>
 #include <board/board_state.h>
+#include <gzip/compress.hpp>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+/*
+ * Random SGNN weights in the sgtrain/converters.py layout (gzip csv: name, shape, values)
+ */
+struct RandomWeightsFixture {
+    RandomWeightsFixture() {
+        std::mt19937 gen(42);
+        std::normal_distribution<double> dist(0.0, 0.1);
+        std::stringstream csv;
+        csv.precision(17);
+        auto layer = [&](const char* name, std::initializer_list<int> shape) {
+            int size = 1;
+            csv << name;
+            for (int dim : shape) { csv << "," << dim; size *= dim; }
+            for (int i=0; i<size; i++) csv << "," << dist(gen);
+            csv << "\n";
+        };
+        layer("l1.weight", {128, 40, 8});
+        layer("l2.weight", {64, 128});
+        layer("l2.bias", {64, 1});
+        layer("lout.weight", {1, 64});
+        layer("lout.bias", {1, 1});
+
+        path = std::filesystem::temp_directory_path() / "sg_random_weights.nn";
+        auto content = csv.str();
+        std::ofstream(path, std::ios::binary) << gzip::compress(content.data(), content.size());
+        opts.NNStateFile = path.string();
+    }
+    ~RandomWeightsFixture() { std::filesystem::remove(path); }
+
+    std::filesystem::path path;
+    common::Options opts{};
+};
+
+/* positions of a short game with captures, enpassant and castling */
+static std::vector<brd::BoardState> gamePositions() {
+    std::vector<brd::Move> game = {
+        brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e4),
+        brd::mkMove(SqNum::sqn_d7, SqNum::sqn_d5),
+        brd::mkMove(SqNum::sqn_e4, SqNum::sqn_e5),
+        brd::mkMove(SqNum::sqn_f7, SqNum::sqn_f5),
+        brd::mkEnpass(SqNum::sqn_e5, SqNum::sqn_f6),
+        brd::mkMove(SqNum::sqn_g8, SqNum::sqn_f6),
+        brd::mkMove(SqNum::sqn_f1, SqNum::sqn_d3),
+        brd::mkMove(SqNum::sqn_e7, SqNum::sqn_e5),
+        brd::mkMove(SqNum::sqn_g1, SqNum::sqn_f3),
+        brd::mkMove(SqNum::sqn_f8, SqNum::sqn_c5),
+        brd::mkCastling(SqNum::sqn_e1, brd::CastlingType::C_SHORT),
+        brd::mkCastling(SqNum::sqn_e8, brd::CastlingType::C_SHORT),
+    };
+    std::vector<brd::BoardState> positions{};
+    brd::BoardState state(brd::Board{});
+    positions.push_back(state);
+    for (auto& mv : game) {
+        state.registerMove(mv);
+        positions.push_back(state);
+    }
+    return positions;
+}
 
 BOOST_AUTO_TEST_SUITE(evals_test_suite)
 
+/*
+ * The first layer is accumulated from the previous leaf of the thread,
+ * the result must not depend on the order the positions are evaluated
+ */
+BOOST_FIXTURE_TEST_CASE(test_nn_accumulator_order_independent, RandomWeightsFixture) {
+    auto positions = gamePositions();
+    std::vector<double> forward{}, backward(positions.size());
+
+    eval::NNEvaluator first(opts);
+    for (auto& state : positions)
+        forward.push_back(first.evaluateRaw(state));
+
+    // a new model starts from a full refresh at the last position
+    eval::NNEvaluator second(opts);
+    for (std::size_t i=positions.size(); i>0; i--)
+        backward[i-1] = second.evaluateRaw(positions[i-1]);
+
+    for (std::size_t i=0; i<positions.size(); i++)
+        BOOST_CHECK_CLOSE(forward[i], backward[i], 1e-9);
+}
+
 
 BOOST_AUTO_TEST_CASE(test_local, *boost::unit_test::disabled()) {
     common::Options opts{};
@@ -39,4 +125,146 @@ BOOST_AUTO_TEST_CASE(test_local, *boost::unit_test::disabled()) {
     std::cout << "best score:" << bestScore << " best move:" << bestMove << std::endl;
 }
 
+/*
+ * The float32 and quantized paths against the double reference over the depth 2 tree.
+ * The reference goes over the tree first, then the checked evaluator walks it alone:
+ * its accumulator is updated leaf by leaf across the refresh period
+ */
+template<typename TVisit>
+static void visitDepth2(TVisit&& visit) {
+    brd::BoardState state(brd::Board{});
+    brd::MoveList moves{};
+    state.legalMovegenFor<PColor::W>(moves);
+    for (std::size_t i=0; i<moves.size(); i++) {
+        state.registerMove(moves[i]);
+        brd::MoveList replies{};
+        state.legalMovegenFor<PColor::B>(replies);
+        for (std::size_t j=0; j<replies.size(); j++) {
+            state.registerMove(replies[j]);
+            visit(state);
+            state.undo();
+        }
+        state.undo();
+    }
+}
+
+static double maxDeviation(const common::Options& reference, const common::Options& checked) {
+    eval::NNEvaluator ref(reference), evalu(checked);
+    std::vector<double> expected{};
+    visitDepth2([&](brd::BoardState& state) { expected.push_back(ref.evaluateRaw(state)); });
+
+    double maxDiff = 0.0;
+    std::size_t leaf = 0;
+    visitDepth2([&](brd::BoardState& state) {
+        maxDiff = std::max(maxDiff, std::abs(expected[leaf++] - evalu.evaluateRaw(state)));
+    });
+    BOOST_REQUIRE_EQUAL(leaf, expected.size());
+    return maxDiff;
+}
+
+BOOST_FIXTURE_TEST_CASE(test_nn_float_matches_double, RandomWeightsFixture) {
+    auto checked = opts;
+    checked.NNInference = common::NNPrecision::Float;
+    BOOST_CHECK_LT(maxDeviation(opts, checked), 1e-5);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_nn_quantized_matches_double, RandomWeightsFixture) {
+    auto checked = opts;
+    checked.NNInference = common::NNPrecision::Quantized;
+    BOOST_CHECK_LT(maxDeviation(opts, checked), 2e-3);
+}
+
+/*
+ * The batch matrix products against the single position path, the depth 2 tree in one batch
+ * (spans several blocks and a partial one)
+ */
+static double maxBatchDeviation(const common::Options& opts) {
+    eval::NNEvaluator evalu(opts);
+    brd::BoardState state(brd::Board{});
+    std::vector<int8_t> planes{};
+    std::vector<double> single{};
+    brd::MoveList moves{};
+    state.legalMovegenFor<PColor::W>(moves);
+    for (std::size_t i=0; i<moves.size(); i++) {
+        state.registerMove(moves[i]);
+        brd::MoveList replies{};
+        state.legalMovegenFor<PColor::B>(replies);
+        for (std::size_t j=0; j<replies.size(); j++) {
+            state.registerMove(replies[j]);
+            planes.insert(planes.end(), state.getNNL().begin(), state.getNNL().end());
+            single.push_back(evalu.evaluateRaw(state));
+            state.undo();
+        }
+        state.undo();
+    }
+
+    std::vector<double> batch(single.size());
+    evalu.evaluateRawBatch(planes.data(), batch.size(), batch.data());
+    double maxDiff = 0.0;
+    for (std::size_t i=0; i<single.size(); i++)
+        maxDiff = std::max(maxDiff, std::abs(single[i] - batch[i]));
+    return maxDiff;
+}
+
+BOOST_FIXTURE_TEST_CASE(test_nn_batch_matches_single, RandomWeightsFixture) {
+    BOOST_CHECK_LT(maxBatchDeviation(opts), 1e-12);
+    opts.NNInference = common::NNPrecision::Float;
+    BOOST_CHECK_LT(maxBatchDeviation(opts), 1e-5);
+    opts.NNInference = common::NNPrecision::Quantized;
+    BOOST_CHECK_LT(maxBatchDeviation(opts), 1e-12);
+}
+
+/*
+ * The binary weights are mapped and used in place, the evaluations must be the csv ones exactly
+ */
+BOOST_FIXTURE_TEST_CASE(test_nn_binary_weights_round_trip, RandomWeightsFixture) {
+    auto binPath = std::filesystem::temp_directory_path() / "sg_random_weights.sgnn";
+    eval::NNEvaluator csv(opts);
+    csv.saveBinary(binPath.string());
+
+    auto binOpts = opts;
+    binOpts.NNStateFile = binPath.string();
+    eval::NNEvaluator bin(binOpts);
+    for (auto& state : gamePositions())
+        BOOST_CHECK_EQUAL(csv.evaluateRaw(state), bin.evaluateRaw(state));
+    std::filesystem::remove(binPath);
+}
+
+BOOST_FIXTURE_TEST_CASE(test_nn_binary_weights_checksum, RandomWeightsFixture) {
+    auto binPath = std::filesystem::temp_directory_path() / "sg_corrupted_weights.sgnn";
+    eval::NNEvaluator(opts).saveBinary(binPath.string());
+    {
+        std::fstream file(binPath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\x5a');
+    }
+
+    auto binOpts = opts;
+    binOpts.NNStateFile = binPath.string();
+    BOOST_CHECK_THROW(eval::NNEvaluator{binOpts}, std::runtime_error);
+    std::filesystem::remove(binPath);
+}
+
+#ifdef SG_EMBEDDED_NN_WEIGHTS
+/*
+ * The embedded weights need no file and are the gzip ones exactly. The pretrained path is mapped
+ * to the embedded array too, the reference is parsed from a copy of the gzip under another path
+ */
+BOOST_AUTO_TEST_CASE(test_nn_embedded_weights) {
+    const auto parsed = eval::nnw::readGzipCsv(NN_GZIP_PRETRAINED_WEIGHTS);
+    BOOST_REQUIRE_EQUAL(parsed.size(), eval::nnw::layout::size);
+    BOOST_CHECK(std::equal(parsed.begin(), parsed.end(), eval::nnw::embeddedWeights));
+
+    auto copyPath = std::filesystem::temp_directory_path() / "sg_pretrained_copy.csv.gz";
+    std::filesystem::copy_file(NN_GZIP_PRETRAINED_WEIGHTS, copyPath,
+                               std::filesystem::copy_options::overwrite_existing);
+    common::Options embedded{}, fromFile{};
+    fromFile.NNStateFile = copyPath.string();
+    eval::NNEvaluator first(embedded), second(fromFile);
+    for (auto& state : gamePositions())
+        BOOST_CHECK_EQUAL(first.evaluateRaw(state), second.evaluateRaw(state));
+    std::filesystem::remove(copyPath);
+}
+#endif
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
@@ -12,6 +12,8 @@
 #include <board/board_state.h>
 #include <dbg/debugger.h>
 #include <common/options.h>
+#include <uci/fen.h>
+#include <core/scores.h>
 #include <future>
 #include <core/ThreadPoolExecutor.h>
 #include <thread>
@@ -547,6 +549,68 @@ BOOST_FIXTURE_TEST_CASE(test_search_cores_100_5, MtdSearchTestFixture) {
                   || res.pvMove.to == SqNum::sqn_e7 || res.pvMove.to == SqNum::sqn_a3);
 }
 
+
+/* king and pawns only: passing may be the best, no null move is tried */
+BOOST_FIXTURE_TEST_CASE(test_null_move_pawn_ending, MtdSearchTestFixture) {
+    brd::BoardState state(brd::Board{});
+    uci::Fen fen;
+    fen.apply("8/8/8/4k3/8/8/4P3/4K3 w - - 0 1", state);
+    BOOST_REQUIRE_EQUAL(state.pieceMaterial(PColor::W), 0);
+    BOOST_REQUIRE_EQUAL(state.pieceMaterial(PColor::B), 0);
+    BOOST_CHECK_EQUAL(state.nonPawnMaterial(PColor::W), PAWN_SCORE);
+
+    opts.MaxDepthPly = 8;
+    opts.EngineSide = PColor::W;
+    eval::MaterialEvaluator evalu{opts};
+    search::MtdSearch<exec::CallerThreadExecutor> searcher{opts, stat, tm, ttable, evalu};
+    auto res = searcher.pvMove(state);
+    BOOST_CHECK(!res.pvMove.NAM());
+    BOOST_CHECK_EQUAL(stat.NullMoveCuts, 0);
+
+    // a rook on the board: the same search passes
+    fen.apply("8/8/8/4k3/8/8/4P3/R3K3 w - - 0 1", state);
+    BOOST_REQUIRE_EQUAL(state.pieceMaterial(PColor::W), ROOK_SCORE);
+    search::MtdSearch<exec::CallerThreadExecutor> rookSearcher{opts, stat, tm, ttable, evalu};
+    res = rookSearcher.pvMove(state);
+    BOOST_CHECK(stat.NullMoveCuts > 0);
+}
+
+
+/* a child probe claiming the slot between the parent's probe and write mustn't own the parent's entry */
+BOOST_FIXTURE_TEST_CASE(test_tt_nested_probe, MtdSearchTestFixture) {
+    const uint64_t chains = opts.AvailMemTT * 1024 / sizeof(search::TTChain);
+    const uint64_t parentKey = 7, childKey = parentKey + chains;
+
+    auto parent = ttable.probe(parentKey);
+    auto child = ttable.probe(childKey);
+    BOOST_REQUIRE(!parent.hit() && !child.hit());
+    child.write(-5, search::EXACT_BND, 1, brd::Move{});
+    parent.write(10, search::LOWER_BND, 2, brd::Move{});
+
+    auto reprobe = ttable.probe(parentKey);
+    BOOST_REQUIRE(reprobe.hit());
+    BOOST_CHECK_EQUAL(reprobe.entry()->score, 10);
+    BOOST_CHECK(!ttable.probe(childKey).hit());
+}
+
+
+/* a quiescence probe misses without claiming: the deep entries of the chain stay */
+BOOST_FIXTURE_TEST_CASE(test_tt_probe_no_claim, MtdSearchTestFixture) {
+    const uint64_t chains = opts.AvailMemTT * 1024 / sizeof(search::TTChain);
+    const uint64_t keys[] = {3, 3 + chains, 3 + 2 * chains};
+    for (unsigned i = 0; i < std::size(keys); i++)
+        ttable.probe(keys[i]).write(static_cast<Score>(i), search::EXACT_BND, 4, brd::Move{});
+
+    auto qdesc = ttable.probe(3 + 3 * chains, false);
+    BOOST_REQUIRE(!qdesc.hit());
+    BOOST_CHECK(qdesc.entry()->horizon);
+    for (unsigned i = 0; i < std::size(keys); i++) {
+        auto desc = ttable.probe(keys[i]);
+        BOOST_REQUIRE(desc.hit());
+        BOOST_CHECK_EQUAL(desc.entry()->score, static_cast<Score>(i));
+    }
+}
+
 // ======================
 
 
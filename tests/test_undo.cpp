@@ -5,6 +5,7 @@
 #include <board/board.h>
 #include <board/board_state.h>
 #include <dbg/debugger.h>
+#include <core/scores.h>
 
 struct UndoTestFixture {
 public:
@@ -162,6 +163,125 @@ BOOST_FIXTURE_TEST_CASE(test_undo_7_moves, UndoTestFixture) {
 
 
 
+/* restore() must leave the same state as undo(), the NN layer included */
+BOOST_FIXTURE_TEST_CASE(test_restore_position, UndoTestFixture) {
+    brd::BoardState state(brd::Board{});
+    std::vector<brd::Move> moves = {
+        brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e4),
+        brd::mkMove(SqNum::sqn_d7, SqNum::sqn_d5),
+        brd::mkMove(SqNum::sqn_e4, SqNum::sqn_e5),
+        brd::mkMove(SqNum::sqn_f7, SqNum::sqn_f5),
+        brd::mkEnpass(SqNum::sqn_e5, SqNum::sqn_f6),
+        brd::mkMove(SqNum::sqn_g8, SqNum::sqn_f6),
+        brd::mkMove(SqNum::sqn_f1, SqNum::sqn_d3),
+        brd::mkMove(SqNum::sqn_e7, SqNum::sqn_e5),
+        brd::mkMove(SqNum::sqn_g1, SqNum::sqn_f3),
+        brd::mkMove(SqNum::sqn_f8, SqNum::sqn_c5),
+        brd::mkCastling(SqNum::sqn_e1, brd::CastlingType::C_SHORT),
+        brd::mkCastling(SqNum::sqn_e8, brd::CastlingType::C_SHORT),
+    };
+
+    std::vector<brd::Position> saved{};
+    for (auto& mv : moves)
+        saved.push_back(brd::CopyMake::make(state, mv));
+
+    brd::BoardState undone(state);
+    for (std::size_t i=moves.size(); i>0; i--) {
+        brd::CopyMake::unmake(state, saved[i-1]);
+        undone.undo();
+
+        BOOST_CHECK_EQUAL(state.ply(), undone.ply());
+        BOOST_CHECK_EQUAL(state.getBoard().key(), undone.getBoard().key());
+        BOOST_CHECK(state.getBoard().getRawBoard() == undone.getBoard().getRawBoard());
+        BOOST_CHECK(state.getNNL() == undone.getNNL());
+        BOOST_CHECK_EQUAL(state.kindNotMoved<PColor::W>(), undone.kindNotMoved<PColor::W>());
+        BOOST_CHECK_EQUAL(state.nonPawnMaterial(PColor::B), undone.nonPawnMaterial(PColor::B));
+    }
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_null_move, UndoTestFixture) {
+    brd::BoardState state(brd::Board{});
+    state.registerMove(brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e4));
+    state.registerMove(brd::mkMove(SqNum::sqn_a7, SqNum::sqn_a6));
+    state.registerMove(brd::mkMove(SqNum::sqn_e4, SqNum::sqn_e5));
+    state.registerMove(brd::mkMove(SqNum::sqn_d7, SqNum::sqn_d5));
+
+    auto hasEnpass = [](const brd::BoardState& st) {
+        brd::MoveList moves{};
+        st.legalMovegenFor<PColor::W>(moves);
+        for (std::size_t i = 0; i < moves.size(); i++)
+            if (moves[i].isEnpass) return true;
+        return false;
+    };
+    const auto key = state.getBoard().key();
+    const auto nnl = state.getNNL();
+    BOOST_REQUIRE(hasEnpass(state));
+    BOOST_CHECK_EQUAL(nnl[256], 1);
+
+    // white passes, black passes: the d5 pawn can't be taken enpassant anymore
+    state.makeNull();
+    BOOST_CHECK(state.getLastMove().isNull);
+    BOOST_CHECK_EQUAL(state.getLastMove().moveColor, PColor::W);
+    BOOST_CHECK(state.getBoard().key() != key);
+    BOOST_CHECK_EQUAL(state.getNNL()[256], 0);
+    BOOST_CHECK_EQUAL(state.getNNL()[288], 1);
+    state.makeNull();
+    BOOST_CHECK_EQUAL(state.getBoard().key(), key);
+    BOOST_CHECK(!hasEnpass(state));
+
+    state.undoNull();
+    state.undoNull();
+    BOOST_CHECK_EQUAL(state.ply(), 4);
+    BOOST_CHECK_EQUAL(state.getBoard().key(), key);
+    BOOST_CHECK(state.getNNL() == nnl);
+    BOOST_CHECK(hasEnpass(state));
+    BOOST_CHECK_EQUAL(state.pieceMaterial(PColor::B), INIT_MATERIAL - 8 * PAWN_SCORE);
+}
+
+
+BOOST_FIXTURE_TEST_CASE(test_history_overflow, UndoTestFixture) {
+    brd::BoardState state(brd::Board{});
+    const brd::Move shuffle[] = {
+        brd::mkMove(SqNum::sqn_g1, SqNum::sqn_f3),
+        brd::mkMove(SqNum::sqn_g8, SqNum::sqn_f6),
+        brd::mkMove(SqNum::sqn_f3, SqNum::sqn_g1),
+        brd::mkMove(SqNum::sqn_f6, SqNum::sqn_g8),
+    };
+    const auto key = state.getBoard().key();
+    constexpr auto capacity = brd::BoardState::MAX_HISTORY_PLY;
+
+    for (std::size_t i = 0; i < capacity; i++)
+        state.registerMove(shuffle[i % 4]);
+    BOOST_REQUIRE_EQUAL(state.ply(), capacity);
+    BOOST_CHECK_EQUAL(state.getBoard().key(), key);
+
+    // a full history drops its two oldest records and stays at the capacity
+    for (std::size_t i = 0; i < 6; i++)
+        state.registerMove(shuffle[i % 4]);
+    BOOST_CHECK_EQUAL(state.ply(), capacity);
+    state.makeNull();
+    BOOST_CHECK_EQUAL(state.ply(), capacity - 1);
+    BOOST_CHECK_EQUAL(state.getLastMove().moveColor, PColor::W);
+    state.undoNull();
+    BOOST_CHECK_EQUAL(brd::getNextPlayerColor(state), PColor::W);
+
+    for (std::size_t i = 0; i < 6; i++)
+        state.undo();
+    BOOST_CHECK_EQUAL(state.getBoard().key(), key);
+    BOOST_CHECK_EQUAL(brd::getNextPlayerColor(state), PColor::W);
+
+    // a new game can't unwind the dropped records, the start position is set up directly
+    state.registerMove(brd::mkMove(SqNum::sqn_e2, SqNum::sqn_e4));
+    state.setupStartPosition();
+    const brd::BoardState fresh(brd::Board{});
+    BOOST_CHECK_EQUAL(state.ply(), 0);
+    BOOST_CHECK_EQUAL(state.getBoard().key(), fresh.getBoard().key());
+    BOOST_CHECK(state.getBoard().getRawBoard() == fresh.getBoard().getRawBoard());
+    BOOST_CHECK(state.getNNL() == fresh.getNNL());
+}
+
+
 BOOST_FIXTURE_TEST_CASE(test_regression_1, UndoTestFixture) {
     brd::Board board{};
     preserveOnlyPositions(board, {W_KING_POS, B_KING_POS, B_PAWN_4_POS, W_QUEEN_POS});